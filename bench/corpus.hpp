@@ -0,0 +1,219 @@
+#ifndef __TREE_SITTERPP_BENCH_CORPUS_HPP__
+#define __TREE_SITTERPP_BENCH_CORPUS_HPP__
+
+#include <cstdint>
+#include <iterator>
+#include <string>
+#include <string_view>
+
+namespace bench {
+
+	/**
+	 * splitmix64, used instead of the <random> distributions (whose output
+	 * differs between standard libraries) so a seed produces the same corpus
+	 * everywhere.
+	 */
+	struct Random {
+		uint64_t state;
+
+		explicit Random(uint64_t seed) : state(seed) { }
+
+		uint64_t next() {
+			uint64_t z = (state += 0x9e3779b97f4a7c15ull);
+			z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+			z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+			return z ^ (z >> 31);
+		}
+		inline uint32_t below(uint32_t n) { return next() % n; }
+		inline bool chance(uint32_t percent) { return below(100) < percent; }
+	};
+
+	/**
+	 * Generates synthetic, syntactically valid C++ which exercises a spread of
+	 * the grammar: includes, namespaces, classes with fields and methods,
+	 * templates, control flow, calls, lambdas, literals, and comments.
+	 */
+	struct CorpusGenerator {
+		static constexpr std::string_view types[] = {"int", "float", "double", "bool", "size_t", "std::string", "std::vector<int>", "auto"};
+		static constexpr std::string_view names[] = {"value", "count", "index", "result", "buffer", "node", "offset", "length", "data", "item", "total", "state"};
+		static constexpr std::string_view functions[] = {"process", "update", "compute", "visit", "emit", "parse", "flush", "reset", "lookup", "merge"};
+		static constexpr std::string_view headers[] = {"vector", "string", "map", "memory", "algorithm", "iostream", "optional", "cstdint"};
+
+		Random random;
+		std::string out;
+		uint32_t indent = 0;
+		uint32_t counter = 0;
+
+		explicit CorpusGenerator(uint64_t seed) : random(seed) { }
+
+		template<size_t N>
+		std::string_view pick(const std::string_view (&options)[N]) { return options[random.below(N)]; }
+
+		// Any type except auto, for parameters and fields
+		std::string concrete_type() { return std::string(types[random.below(std::size(types) - 1)]); }
+
+		std::string name() { return std::string(pick(names)) + std::to_string(random.below(16)); }
+
+		void line(const std::string_view text) {
+			out.append(indent, '\t');
+			out += text;
+			out += '\n';
+		}
+
+		// The operands of + are unsequenced, so every random choice is made in its own statement to keep corpora identical across compilers
+		std::string expression(uint32_t depth = 0) {
+			std::string out;
+			switch(depth > 2 ? random.below(3) : random.below(7)) {
+			case 0: return name();
+			case 1: return std::to_string(random.below(1000));
+			case 2:
+				out = "\"" + std::string(pick(names));
+				out += " " + std::to_string(random.below(100)) + "\"";
+				return out;
+			case 3:
+				out = expression(depth + 1);
+				out += random.chance(50) ? " + " : " * ";
+				out += expression(depth + 1);
+				return out;
+			case 4:
+				out = std::string(pick(functions)) + "(";
+				out += expression(depth + 1) + ", ";
+				out += expression(depth + 1) + ")";
+				return out;
+			case 5:
+				out = name() + ".";
+				out += std::string(pick(functions)) + "(";
+				out += expression(depth + 1) + ")";
+				return out;
+			default:
+				out = "(" + expression(depth + 1);
+				out += " < " + expression(depth + 1) + ")";
+				return out;
+			}
+		}
+
+		void statement(uint32_t depth) {
+			std::string out;
+			switch(depth > 2 ? random.below(3) : random.below(8)) {
+			case 0:
+				out = std::string(pick(types)) + " ";
+				out += name() + " = ";
+				out += expression() + ";";
+				line(out);
+				break;
+			case 1:
+				out = name() + " = ";
+				out += expression() + ";";
+				line(out);
+				break;
+			case 2:
+				out = std::string(pick(functions)) + "(";
+				out += expression() + ");";
+				line(out);
+				break;
+			case 3:
+				line("if (" + expression() + ") {");
+				block(depth);
+				if(random.chance(40)) {
+					line("} else {");
+					block(depth);
+				}
+				line("}");
+				break;
+			case 4: {
+				std::string i = "i" + std::to_string(depth);
+				line("for (int " + i + " = 0; " + i + " < " + name() + "; " + i + "++) {");
+				block(depth);
+				line("}");
+				break;
+			}
+			case 5:
+				line("while (" + expression() + ") {");
+				block(depth);
+				line("}");
+				break;
+			case 6:
+				out = "auto " + name();
+				out += " = [&](int " + name();
+				out += ") { return " + expression() + "; };";
+				line(out);
+				break;
+			default:
+				out = "// " + std::string(pick(functions));
+				out += " the " + std::string(pick(names));
+				line(out);
+				break;
+			}
+		}
+
+		void block(uint32_t depth) {
+			indent++;
+			for(uint32_t i = 0, n = 1 + random.below(4); i < n; i++)
+				statement(depth + 1);
+			indent--;
+		}
+
+		void function() {
+			std::string signature = concrete_type() + " ";
+			signature += std::string(pick(functions)) + std::to_string(counter++) + "(";
+			for(uint32_t i = 0, n = random.below(4); i < n; i++) {
+				signature += (i ? ", " : "") + concrete_type();
+				signature += " " + name();
+			}
+			if(random.chance(20)) line("template<typename T>");
+			line(signature + ") {");
+			block(0);
+			indent++;
+			line("return " + expression() + ";");
+			indent--;
+			line("}");
+			line("");
+		}
+
+		void structure() {
+			line("struct " + std::string(pick(functions)) + "_type" + std::to_string(counter++) + " {");
+			indent++;
+			for(uint32_t i = 0, n = 1 + random.below(5); i < n; i++) {
+				std::string field = concrete_type();
+				line(field + " " + name() + ";");
+			}
+			indent--;
+			for(uint32_t i = 0, n = random.below(3); i < n; i++) {
+				indent++;
+				function();
+				indent--;
+			}
+			line("};");
+			line("");
+		}
+
+		/**
+		 * Generate at least `bytes` of source.
+		 */
+		std::string generate(size_t bytes) {
+			out.clear();
+			out.reserve(bytes + 1024);
+			for(uint32_t i = 0, n = 1 + random.below(6); i < n; i++)
+				line("#include <" + std::string(pick(headers)) + ">");
+			line("");
+			while(out.size() < bytes) {
+				bool wrap = random.chance(30);
+				if(wrap) {
+					line("namespace " + std::string(pick(names)) + std::to_string(counter++) + " {");
+					line("");
+				}
+				for(uint32_t i = 0, n = 1 + random.below(4); i < n && out.size() < bytes; i++)
+					random.chance(30) ? structure() : function();
+				if(wrap) line("}");
+			}
+			return std::move(out);
+		}
+	};
+
+	/**
+	 * Generate a deterministic corpus of at least `bytes` of C++.
+	 */
+	inline std::string generate_cpp(size_t bytes, uint64_t seed) { return CorpusGenerator(seed ^ bytes).generate(bytes); }
+}
+
+#endif // __TREE_SITTERPP_BENCH_CORPUS_HPP__
\ No newline at end of file
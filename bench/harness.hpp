@@ -0,0 +1,111 @@
+#ifndef __TREE_SITTERPP_BENCH_HARNESS_HPP__
+#define __TREE_SITTERPP_BENCH_HARNESS_HPP__
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace bench {
+
+	// Keeps the compiler from optimizing away a value which is otherwise unused
+	template<typename T>
+	inline void keep(const T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+		asm volatile("" : : "g"(&value) : "memory");
+#else
+		static volatile const void* sink;
+		sink = &value;
+#endif
+	}
+
+	struct Result {
+		std::string name;
+		std::vector<std::pair<std::string, std::string>> params;
+		std::vector<std::pair<std::string, double>> metrics;
+
+		Result& param(std::string key, std::string value) { params.emplace_back(std::move(key), "\"" + value + "\""); return *this; }
+		Result& param(std::string key, double value) { params.emplace_back(std::move(key), format(value)); return *this; }
+		Result& metric(std::string key, double value) { metrics.emplace_back(std::move(key), value); return *this; }
+
+		static std::string format(double value) {
+			if(!std::isfinite(value)) return "null";
+			char buffer[64];
+			snprintf(buffer, sizeof(buffer), "%.6g", value);
+			return buffer;
+		}
+	};
+
+	/**
+	 * Collects benchmark results and times benchmark bodies.
+	 */
+	struct Runner {
+		bool quick = false;
+		std::string filter;
+		std::vector<Result> results;
+
+		/**
+		 * Check if the benchmark with the given name was selected on the command line.
+		 */
+		inline bool enabled(const std::string_view name) const { return filter.empty() || name.find(filter) != std::string_view::npos; }
+
+		Result& add(std::string name) {
+			results.push_back({std::move(name), {}, {}});
+			fprintf(stderr, "running %s\n", results.back().name.c_str());
+			return results.back();
+		}
+
+		/**
+		 * Run `body` repeatedly and return the median time of one run in seconds.
+		 * `setup` runs untimed before every run.
+		 */
+		template<typename Setup, typename Body>
+		double time(Setup&& setup, Body&& body) {
+			using clock = std::chrono::steady_clock;
+			const double budget = quick ? 0.05 : 0.5;
+			const size_t min_samples = quick ? 3 : 7, max_samples = 10000;
+
+			std::vector<double> samples;
+			double total = 0;
+			while(samples.size() < max_samples && (samples.size() < min_samples || total < budget)) {
+				setup();
+				auto start = clock::now();
+				body();
+				double elapsed = std::chrono::duration<double>(clock::now() - start).count();
+				samples.push_back(elapsed);
+				total += elapsed;
+			}
+			std::nth_element(samples.begin(), samples.begin() + samples.size() / 2, samples.end());
+			return samples[samples.size() / 2];
+		}
+		template<typename Body>
+		double time(Body&& body) { return time([] {}, body); }
+
+		/**
+		 * Write every result as a JSON document.
+		 */
+		void write_json(FILE* out, const std::vector<std::pair<std::string, std::string>>& context) const {
+			fprintf(out, "{\n");
+			for(auto& [key, value]: context)
+				fprintf(out, "  \"%s\": %s,\n", key.c_str(), value.c_str());
+			fprintf(out, "  \"results\": [");
+			for(size_t r = 0; r < results.size(); r++) {
+				auto& result = results[r];
+				fprintf(out, "%s\n    {\"name\": \"%s\", \"params\": {", r ? "," : "", result.name.c_str());
+				for(size_t i = 0; i < result.params.size(); i++)
+					fprintf(out, "%s\"%s\": %s", i ? ", " : "", result.params[i].first.c_str(), result.params[i].second.c_str());
+				fprintf(out, "}, \"metrics\": {");
+				for(size_t i = 0; i < result.metrics.size(); i++)
+					fprintf(out, "%s\"%s\": %s", i ? ", " : "", result.metrics[i].first.c_str(), Result::format(result.metrics[i].second).c_str());
+				fprintf(out, "}}");
+			}
+			fprintf(out, "\n  ]\n}\n");
+		}
+	};
+}
+
+#endif // __TREE_SITTERPP_BENCH_HARNESS_HPP__
\ No newline at end of file
@@ -0,0 +1,474 @@
+// tspp_bench: measures the wrapper's overhead against the raw C API on synthetic C++ corpora.
+//
+// Usage: tspp_bench [--quick] [--filter <name>] [--seed <n>] [--out <file.json>]
+//
+// Results are written as JSON (to stdout unless --out is given), progress goes to stderr.
+
+#include "corpus.hpp"
+#include "harness.hpp"
+
+#include "tree-sitterpp/allocator.hpp"
+#include "tree-sitterpp/document.hpp"
+#include "tree-sitterpp/flat_tree.hpp"
+#include "tree-sitterpp/flat_tree_file.hpp"
+#include "tree-sitterpp/languages/cpp.hpp"
+#include "tree-sitterpp/parser.hpp"
+#include "tree-sitterpp/query.hpp"
+#include "tree-sitterpp/visitor.hpp"
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace bench;
+
+namespace {
+	constexpr double MB = 1024 * 1024;
+
+	uint32_t count_nodes(const ts::Tree& tree) {
+		uint32_t count = 0;
+		for(auto node: tree.preorder()) {
+			keep(node);
+			count++;
+		}
+		return count;
+	}
+
+	// Parse throughput of the wrapper and of the raw C API, by file size
+	void bench_parse(Runner& runner, uint64_t seed) {
+		std::vector<size_t> sizes = {1024, 16 * 1024, 256 * 1024, 4 * 1024 * 1024};
+		if(runner.quick) sizes.pop_back();
+
+		ts::Parser parser(ts::cpp::language());
+		TSParser* raw = ts_parser_new();
+		ts_parser_set_language(raw, ts::cpp::language());
+
+		for(size_t size: sizes) {
+			std::string source = generate_cpp(size, seed);
+			double wrapper = runner.time([&] { keep(parser.parse_string(source)); });
+			double c_api = runner.time([&] { ts_tree_delete(ts_parser_parse_string(raw, nullptr, source.data(), source.size())); });
+
+			runner.add("parse").param("bytes", source.size())
+				.metric("wrapper_mb_per_s", source.size() / MB / wrapper)
+				.metric("c_api_mb_per_s", source.size() / MB / c_api)
+				.metric("overhead_ratio", wrapper / c_api);
+		}
+		ts_parser_delete(raw);
+	}
+
+	// Single character edits followed by an incremental reparse and changed ranges, as an editor would do
+	void bench_edit(Runner& runner, uint64_t seed) {
+		std::string source = generate_cpp(256 * 1024, seed);
+		Random random(seed);
+		auto position = [&] { return (uint32_t)random.below(source.size()); };
+
+		// Alternate inserting a space and erasing it again so the text stays put
+		ts::Document document(ts::cpp::language(), source);
+		keep(document.tree());
+		bool insert = true;
+		uint32_t at = 0;
+		size_t changed = 0, edits = 0;
+		double wrapper = runner.time([&] { if(insert) at = position(); }, [&] {
+			insert ? document.insert(at, " ") : document.erase(at, 1);
+			insert = !insert;
+			keep(document.tree());
+			changed += document.changed_ranges().size();
+			edits++;
+		});
+
+		// The same loop against the C API, editing a flat string. Finding the
+		// edit's position is left untimed since the document does that itself
+		TSParser* raw = ts_parser_new();
+		ts_parser_set_language(raw, ts::cpp::language());
+		std::string text = source;
+		TSTree* tree = ts_parser_parse_string(raw, nullptr, text.data(), text.size());
+		auto point = [&](uint32_t byte) {
+			uint32_t row = std::count(text.begin(), text.begin() + byte, '\n');
+			size_t line = text.rfind('\n', byte ? byte - 1 : 0);
+			uint32_t column = byte - (line == std::string::npos || byte == 0 ? 0 : line + 1);
+			return TSPoint{row, column};
+		};
+		insert = true;
+		TSPoint start;
+		double c_api = runner.time([&] {
+			if(insert) at = position();
+			start = point(at);
+		}, [&] {
+			TSInputEdit edit{at, at, at + 1, start, start, {start.row, start.column + 1}};
+			if(insert) text.insert(at, 1, ' ');
+			else {
+				std::swap(edit.old_end_byte, edit.new_end_byte);
+				std::swap(edit.old_end_point, edit.new_end_point);
+				text.erase(at, 1);
+			}
+			insert = !insert;
+			ts_tree_edit(tree, &edit);
+			TSTree* next = ts_parser_parse_string(raw, tree, text.data(), text.size());
+			uint32_t length;
+			ts::detail::free_ts_memory(ts_tree_get_changed_ranges(tree, next, &length));
+			ts_tree_delete(tree);
+			tree = next;
+		});
+		ts_tree_delete(tree);
+		ts_parser_delete(raw);
+
+		runner.add("incremental_edit").param("bytes", source.size())
+			.metric("wrapper_us", wrapper * 1e6)
+			.metric("c_api_us", c_api * 1e6)
+			.metric("changed_ranges_per_edit", edits ? double(changed) / edits : 0);
+	}
+
+	// Walks every node of a tree using child(i), a TreeCursor, the traversal views, and the raw cursor
+	void bench_traversal(Runner& runner, uint64_t seed) {
+		std::string source = generate_cpp(256 * 1024, seed);
+		ts::Parser parser(ts::cpp::language());
+		ts::Tree tree = parser.parse_string(source);
+		uint32_t nodes = count_nodes(tree);
+		auto per_node = [&](double seconds) { return seconds * 1e9 / nodes; };
+
+		auto child_walk = [](auto& self, const ts::Node& node) -> void {
+			keep(node);
+			for(uint32_t i = 0, count = node.child_count(); i < count; i++)
+				self(self, node.child(i));
+		};
+		double child = runner.time([&] { child_walk(child_walk, tree.root_node()); });
+
+		double cursor = runner.time([&] {
+			ts::TreeCursor cursor(tree.root_node());
+			while(true) {
+				keep(cursor.current_node());
+				if(cursor.goto_first_child()) continue;
+				while(!cursor.goto_next_sibling())
+					if(!cursor.goto_parent()) return;
+			}
+		});
+
+		double view = runner.time([&] { for(auto node: tree.preorder()) keep(node); });
+
+		double c_api = runner.time([&] {
+			TSTreeCursor cursor = ts_tree_cursor_new(ts_tree_root_node(tree));
+			while(true) {
+				keep(ts_tree_cursor_current_node(&cursor));
+				if(ts_tree_cursor_goto_first_child(&cursor)) continue;
+				bool done = false;
+				while(!done && !ts_tree_cursor_goto_next_sibling(&cursor))
+					done = !ts_tree_cursor_goto_parent(&cursor);
+				if(done) break;
+			}
+			ts_tree_cursor_delete(&cursor);
+		});
+
+		ts::FlatTree flat;
+		double flatten = runner.time([&] { flat.build(tree.root_node()); });
+		double flat_scan = runner.time([&] {
+			uint32_t named = 0;
+			for(uint32_t i = 0; i < flat.size(); i++) named += flat.is_named(i);
+			keep(named);
+		});
+
+		runner.add("traversal").param("bytes", source.size()).param("nodes", nodes)
+			.metric("child_index_walk_ns_per_node", per_node(child))
+			.metric("tree_cursor_ns_per_node", per_node(cursor))
+			.metric("preorder_view_ns_per_node", per_node(view))
+			.metric("c_api_cursor_ns_per_node", per_node(c_api))
+			.metric("flat_tree_build_ns_per_node", per_node(flatten))
+			.metric("flat_tree_scan_ns_per_node", per_node(flat_scan));
+	}
+
+	// Cost of finding a node's position and field in its parent
+	void bench_child_index(Runner& runner, uint64_t seed) {
+		std::string source = generate_cpp(256 * 1024, seed);
+		ts::Parser parser(ts::cpp::language());
+		ts::Tree tree = parser.parse_string(source);
+
+		std::vector<ts::Node> sample;
+		uint32_t i = 0;
+		for(auto node: tree.preorder())
+			if(i++ % 16 == 0) sample.push_back(node);
+
+		double child_index = runner.time([&] { for(auto& node: sample) keep(node.child_index()); });
+		double field_name = runner.time([&] { for(auto& node: sample) keep(node.field_name()); });
+
+		// The prev_sibling walk child_index used to be
+		double c_api_siblings = runner.time([&] {
+			for(auto& node: sample) {
+				uint32_t index = 0;
+				for(TSNode n = ts_node_prev_sibling(node); !ts_node_is_null(n); n = ts_node_prev_sibling(n)) index++;
+				keep(index);
+			}
+		});
+
+		// Tracked while walking with a cursor, for every node rather than the sample
+		uint32_t nodes = 0;
+		double cursor = runner.time([&] { nodes = 0; }, [&] {
+			ts::TreeCursor cursor(tree.root_node());
+			while(true) {
+				keep(cursor.current_child_index());
+				keep(cursor.current_field_name());
+				nodes++;
+				if(cursor.goto_first_child()) continue;
+				while(!cursor.goto_next_sibling())
+					if(!cursor.goto_parent()) return;
+			}
+		});
+
+		runner.add("child_index").param("bytes", source.size()).param("sampled_nodes", sample.size())
+			.metric("node_child_index_ns", child_index * 1e9 / sample.size())
+			.metric("node_field_name_ns", field_name * 1e9 / sample.size())
+			.metric("c_api_prev_sibling_walk_ns", c_api_siblings * 1e9 / sample.size())
+			.metric("cursor_tracked_ns_per_node", cursor * 1e9 / std::max<uint32_t>(nodes, 1));
+
+		// Node::child_index has to find the parent from the root, so its cost grows with depth while the cursor's doesn't
+		std::vector<uint32_t> depths = {4, 16, 64, 256};
+		if(runner.quick) depths.pop_back();
+		for(uint32_t depth: depths) {
+			std::string nested = "void f() " + std::string(depth, '{') + " a = 1; b = 2; c = 3; " + std::string(depth, '}') + "\n";
+			ts::Tree nested_tree = parser.parse_string(nested);
+
+			// The nodes at the deepest level, found with a cursor which knows its depth
+			std::vector<ts::Node> deepest;
+			uint32_t max_depth = 0;
+			ts::TreeCursor walk(nested_tree.root_node());
+			while(true) {
+				if(walk.current_depth() > max_depth) {
+					max_depth = walk.current_depth();
+					deepest.clear();
+				}
+				if(walk.current_depth() == max_depth) deepest.push_back(walk.current_node());
+				if(walk.goto_first_child()) continue;
+				bool finished = false;
+				while(!finished && !walk.goto_next_sibling())
+					finished = !walk.goto_parent();
+				if(finished) break;
+			}
+
+			double node_index = runner.time([&] { for(auto& node: deepest) keep(node.child_index()); });
+			uint32_t visited = 0;
+			double cursor_index = runner.time([&] { visited = 0; }, [&] {
+				ts::TreeCursor cursor(nested_tree.root_node());
+				while(true) {
+					keep(cursor.current_child_index());
+					visited++;
+					if(cursor.goto_first_child()) continue;
+					while(!cursor.goto_next_sibling())
+						if(!cursor.goto_parent()) return;
+				}
+			});
+
+			runner.add("child_index_depth").param("nesting", depth).param("tree_depth", max_depth).param("sampled_nodes", deepest.size())
+				.metric("node_child_index_ns", node_index * 1e9 / std::max<size_t>(deepest.size(), 1))
+				.metric("cursor_tracked_ns_per_node", cursor_index * 1e9 / std::max<uint32_t>(visited, 1));
+		}
+	}
+
+	// Match throughput of a small highlighting style query
+	void bench_query(Runner& runner, uint64_t seed) {
+		std::string source = generate_cpp(256 * 1024, seed);
+		ts::Parser parser(ts::cpp::language());
+		ts::Tree tree = parser.parse_string(source);
+
+		ts::Query query(ts::cpp::language(),
+			"(call_expression function: (identifier) @call)\n"
+			"(function_definition declarator: (function_declarator declarator: (identifier) @definition))\n"
+			"(field_declaration declarator: (field_identifier) @field)\n"
+			"(string_literal) @string\n");
+		if(!query) {
+			fprintf(stderr, "query failed to compile, skipping\n");
+			return;
+		}
+
+		ts::QueryCursor cursor;
+		size_t matches = 0;
+		double wrapper = runner.time([&] { matches = 0; }, [&] {
+			for(auto& match: cursor.matches(query, tree.root_node())) {
+				keep(match);
+				matches++;
+			}
+		});
+
+		TSQueryCursor* raw = ts_query_cursor_new();
+		double c_api = runner.time([&] {
+			ts_query_cursor_exec(raw, query, ts_tree_root_node(tree));
+			TSQueryMatch match;
+			while(ts_query_cursor_next_match(raw, &match)) keep(match);
+		});
+		ts_query_cursor_delete(raw);
+
+		runner.add("query").param("bytes", source.size()).param("matches", matches)
+			.metric("wrapper_matches_per_s", matches / wrapper)
+			.metric("c_api_matches_per_s", matches / c_api)
+			.metric("wrapper_mb_per_s", source.size() / MB / wrapper)
+			.metric("overhead_ratio", wrapper / c_api);
+	}
+
+	// Per symbol dispatch while walking, by type string comparison, by switch and by a visitor's jump table
+	void bench_visitor(Runner& runner, uint64_t seed) {
+		std::string source = generate_cpp(256 * 1024, seed);
+		ts::Parser parser(ts::cpp::language());
+		ts::Tree tree = parser.parse_string(source);
+		uint32_t nodes = count_nodes(tree);
+		auto per_node = [&](double seconds) { return seconds * 1e9 / nodes; };
+
+		uint32_t calls = 0, definitions = 0, strings = 0;
+		auto reset = [&] { calls = definitions = strings = 0; };
+
+		double type_strings = runner.time(reset, [&] {
+			for(auto node: tree.preorder()) {
+				std::string_view type = node.type();
+				if(type == "call_expression") calls++;
+				else if(type == "function_definition") definitions++;
+				else if(type == "string_literal") strings++;
+			}
+		});
+
+		double symbol_switch = runner.time(reset, [&] {
+			for(auto node: tree.preorder())
+				switch(node.symbol()) {
+				case ts::cpp::call_expression: calls++; break;
+				case ts::cpp::function_definition: definitions++; break;
+				case ts::cpp::string_literal: strings++; break;
+				default: break;
+				}
+		});
+
+		ts::Visitor visitor{
+			ts::on<ts::cpp::call_expression>([&](const ts::Node&) { calls++; }),
+			ts::on<ts::cpp::function_definition>([&](const ts::Node&) { definitions++; }),
+			ts::on<ts::cpp::string_literal>([&](const ts::Node&) { strings++; }),
+		};
+		double visit = runner.time(reset, [&] { visitor.walk(tree.root_node()); });
+
+		runner.add("visitor").param("bytes", source.size()).param("nodes", nodes).param("handled", calls + definitions + strings)
+			.metric("type_string_ns_per_node", per_node(type_strings))
+			.metric("symbol_switch_ns_per_node", per_node(symbol_switch))
+			.metric("visitor_ns_per_node", per_node(visit));
+	}
+
+	// Counts the bytes tree-sitter has allocated, only sees them when the allocator hooks are enabled
+	struct CountingAllocator : ts::Allocator {
+		size_t live = 0, peak = 0;
+
+		void* allocate(size_t size) override {
+			live += size;
+			peak = std::max(peak, live);
+			return malloc(size);
+		}
+		void deallocate(void* memory, size_t size) override {
+			live -= size;
+			free(memory);
+		}
+	};
+
+	void bench_memory(Runner& runner, uint64_t seed) {
+		std::string source = generate_cpp(1024 * 1024, seed);
+		auto& result = runner.add("memory");
+		result.param("bytes", source.size());
+
+		CountingAllocator counter;
+		ts::Tree tree;
+		{
+			ts::AllocatorScope scope(counter);
+			ts::Parser parser(ts::cpp::language());
+			size_t before = counter.live;
+			tree = parser.parse_string(source);
+			if constexpr(ts::allocator_hooks_enabled) {
+				uint32_t nodes = count_nodes(tree);
+				result.param("nodes", nodes)
+					.metric("tree_bytes_per_node", double(counter.live - before) / nodes)
+					.metric("tree_bytes_per_source_byte", double(counter.live - before) / source.size())
+					.metric("peak_parse_bytes", counter.peak);
+			}
+			tree = {}; // Freed while the counter is still alive
+		}
+
+		ts::Parser parser(ts::cpp::language());
+		ts::FlatTree flat(parser.parse_string(source));
+		size_t flat_bytes = 0;
+		ts::detail::for_each_column(flat, [&](auto span) { flat_bytes += span.size_bytes(); });
+		result.metric("flat_tree_bytes_per_node", double(flat_bytes) / flat.size());
+	}
+
+	// Many small files parsed with tree-sitter allocating through malloc and through a reset-per-batch arena
+	void bench_allocator(Runner& runner, uint64_t seed) {
+		if constexpr(!ts::allocator_hooks_enabled) {
+			fprintf(stderr, "allocator hooks are disabled (configure with -DTREE_SITTERPP_ALLOCATOR_HOOKS=ON), skipping\n");
+			return;
+		}
+
+		std::vector<std::string> files;
+		size_t bytes = 0;
+		for(size_t i = 0; i < (runner.quick ? 64 : 256); i++) {
+			files.push_back(generate_cpp(4 * 1024, seed + i));
+			bytes += files.back().size();
+		}
+
+		ts::Parser parser(ts::cpp::language());
+		std::vector<ts::Tree> trees(files.size());
+		double system = runner.time([&] {
+			for(size_t i = 0; i < files.size(); i++) trees[i] = parser.parse_string(files[i]);
+			for(auto& tree: trees) tree = {};
+		});
+
+		ts::ArenaAllocator arena;
+		double arena_time = runner.time([&] {
+			{
+				ts::AllocatorScope scope(arena);
+				ts::Parser arena_parser(ts::cpp::language());
+				for(size_t i = 0; i < files.size(); i++) trees[i] = arena_parser.parse_string(files[i]);
+				for(auto& tree: trees) tree = {};
+			}
+			arena.reset();
+		});
+
+		runner.add("allocator").param("files", files.size()).param("bytes", bytes)
+			.metric("malloc_mb_per_s", bytes / MB / system)
+			.metric("arena_mb_per_s", bytes / MB / arena_time)
+			.metric("speedup", system / arena_time);
+	}
+}
+
+int main(int argc, char** argv) {
+	Runner runner;
+	uint64_t seed = 0x7473707062656e63; // "tsppbenc"
+	const char* output = nullptr;
+	for(int i = 1; i < argc; i++) {
+		std::string_view arg = argv[i];
+		if(arg == "--quick") runner.quick = true;
+		else if(arg == "--filter" && i + 1 < argc) runner.filter = argv[++i];
+		else if(arg == "--seed" && i + 1 < argc) seed = std::stoull(argv[++i]);
+		else if(arg == "--out" && i + 1 < argc) output = argv[++i];
+		else {
+			fprintf(stderr, "usage: %s [--quick] [--filter <name>] [--seed <n>] [--out <file.json>]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	struct { const char* name; void (*run)(Runner&, uint64_t); } benchmarks[] = {
+		{"parse", bench_parse},
+		{"incremental_edit", bench_edit},
+		{"traversal", bench_traversal},
+		{"child_index", bench_child_index},
+		{"query", bench_query},
+		{"visitor", bench_visitor},
+		{"memory", bench_memory},
+		{"allocator", bench_allocator},
+	};
+	for(auto& benchmark: benchmarks)
+		if(runner.enabled(benchmark.name)) benchmark.run(runner, seed);
+
+	FILE* out = output ? fopen(output, "w") : stdout;
+	if(!out) {
+		fprintf(stderr, "couldn't open %s\n", output);
+		return 1;
+	}
+	runner.write_json(out, {
+		{"benchmark", "\"tspp_bench\""},
+		{"format_version", "1"},
+		{"seed", std::to_string(seed)},
+		{"quick", runner.quick ? "true" : "false"},
+		{"allocator_hooks", ts::allocator_hooks_enabled ? "true" : "false"},
+		{"tree_sitter_language_version", std::to_string(TREE_SITTER_LANGUAGE_VERSION)},
+	});
+	if(output) fclose(out);
+	return 0;
+}
\ No newline at end of file
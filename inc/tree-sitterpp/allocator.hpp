@@ -0,0 +1,294 @@
+#ifndef __TREE_SITTERPP_ALLOCATOR_HPP__
+#define __TREE_SITTERPP_ALLOCATOR_HPP__
+
+#include "helpers.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <vector>
+
+/**
+ * Allocator hooks
+ *
+ * Every allocation tree-sitter makes can be forwarded to the calling thread's
+ * current `ts::Allocator`. To enable this configure with
+ * `-DTREE_SITTERPP_ALLOCATOR_HOOKS=ON`, which builds the `ts_record_*`
+ * functions below into the library and picks how to install them from the
+ * bundled tree-sitter's headers:
+ * - tree-sitter 0.20 calls them itself when compiled with
+ *   `TREE_SITTER_ALLOCATION_TRACKING`.
+ * - Newer versions take them through `ts_set_allocator`
+ *   (`TREE_SITTERPP_ALLOCATOR_SET_ALLOCATOR`), which `Parser`, `Query` and
+ *   `QueryCursor` call before creating their first object. Anything created
+ *   directly through the C API before then would be allocated with `malloc`,
+ *   and must not be freed through the hooks.
+ * Configuring fails if the tree-sitter version supports neither. Without the
+ * hooks `AllocatorScope` still compiles but has no effect.
+ *
+ * Every allocation is prefixed with a small header recording the allocator it
+ * came from, so memory freed or resized outside the scope still reaches the
+ * right allocator (which must then be safe to use from that thread).
+ */
+
+namespace TreeSitter {
+
+	// True if tree-sitter's allocations are routed through `ts::Allocator`
+#ifdef TREE_SITTERPP_ALLOCATOR_HOOKS
+	constexpr bool allocator_hooks_enabled = true;
+#else
+	constexpr bool allocator_hooks_enabled = false;
+#endif
+
+	/**
+	 * Memory source used for tree-sitter's allocations while it is installed
+	 * with an `AllocatorScope`.
+	 *
+	 * Allocations only need to be aligned to `alignof(std::max_align_t)`.
+	 */
+	struct Allocator {
+		virtual ~Allocator() = default;
+		virtual void* allocate(size_t size) = 0;
+		virtual void deallocate(void* memory, size_t size) = 0;
+
+		/**
+		 * Resize an allocation, by default a new block is allocated and the
+		 * contents copied over.
+		 */
+		virtual void* reallocate(void* memory, size_t old_size, size_t new_size) {
+			void* out = allocate(new_size);
+			if(out && memory) {
+				std::memcpy(out, memory, std::min(old_size, new_size));
+				deallocate(memory, old_size);
+			}
+			return out;
+		}
+	};
+
+	/**
+	 * Allocator which forwards to `malloc` and `free`, used when no other
+	 * allocator is installed.
+	 */
+	struct MallocAllocator : Allocator {
+		void* allocate(size_t size) override { return malloc(size); }
+		void deallocate(void* memory, size_t) override { free(memory); }
+		void* reallocate(void* memory, size_t, size_t new_size) override { return realloc(memory, new_size); }
+
+		static MallocAllocator& instance() {
+			static MallocAllocator allocator;
+			return allocator;
+		}
+	};
+
+	/**
+	 * Bump allocator which hands out memory from large blocks and releases it
+	 * all at once.
+	 *
+	 * Freeing is a no-op (except for the most recent allocation, which is given
+	 * back so growing arrays can resize in place), so a batch of trees parsed in
+	 * an arena costs almost nothing to allocate. Everything is released by
+	 * `reset` or when the arena is destroyed; any tree or parser allocated in the
+	 * arena must be deleted (or released without deleting it) before then.
+	 *
+	 * A parser keeps internal pools (stack nodes, reusable subtrees) which it
+	 * fills while parsing, so a parser used inside an arena's scope must also be
+	 * created and destroyed inside it; a parser created outside would go on
+	 * using pooled memory from the arena after `reset`.
+	 *
+	 * An arena is not thread safe. Memory is always freed or resized by the
+	 * allocator it came from, even when that happens on another thread, so trees
+	 * allocated in an arena (and copies of them) must stay on the arena's thread
+	 * and be deleted before the scope ends.
+	 */
+	struct ArenaAllocator : Allocator {
+		static constexpr size_t alignment = alignof(std::max_align_t);
+
+		struct Block {
+			char* data;
+			size_t size;
+		};
+
+		size_t block_size;
+		std::vector<Block> blocks;
+		size_t offset = 0; // Into the last block
+		void* last = nullptr;
+		size_t used_bytes = 0;
+
+		explicit ArenaAllocator(size_t block_size = 1024 * 1024) : block_size(block_size) { }
+		ArenaAllocator(const ArenaAllocator&) = delete;
+		ArenaAllocator& operator=(const ArenaAllocator&) = delete;
+		~ArenaAllocator() { release(); }
+
+		static constexpr size_t round_up(size_t size) { return (size + alignment - 1) & ~(alignment - 1); }
+
+		void* allocate(size_t size) override {
+			size = round_up(std::max<size_t>(size, 1));
+			if(blocks.empty() || offset + size > blocks.back().size) {
+				size_t new_size = std::max(block_size, size);
+				char* data = (char*)malloc(new_size);
+				if(!data) return nullptr;
+				blocks.push_back({data, new_size});
+				offset = 0;
+			}
+			last = blocks.back().data + offset;
+			offset += size;
+			used_bytes += size;
+			return last;
+		}
+
+		void deallocate(void* memory, size_t size) override {
+			if(memory && memory == last) {
+				size = round_up(std::max<size_t>(size, 1));
+				offset -= size;
+				used_bytes -= size;
+				last = nullptr;
+			}
+		}
+
+		void* reallocate(void* memory, size_t old_size, size_t new_size) override {
+			// The most recent allocation can grow or shrink in place while the block has room
+			if(memory && memory == last) {
+				size_t start = (char*)memory - blocks.back().data;
+				size_t old_rounded = round_up(std::max<size_t>(old_size, 1)), new_rounded = round_up(std::max<size_t>(new_size, 1));
+				if(start + new_rounded <= blocks.back().size) {
+					offset = start + new_rounded;
+					used_bytes = used_bytes - old_rounded + new_rounded;
+					return memory;
+				}
+			}
+			return Allocator::reallocate(memory, old_size, new_size);
+		}
+
+		/**
+		 * Free everything allocated from the arena, keeping the first block for reuse.
+		 */
+		void reset() {
+			for(size_t i = 1; i < blocks.size(); i++)
+				free(blocks[i].data);
+			if(!blocks.empty()) blocks.resize(1);
+			offset = used_bytes = 0;
+			last = nullptr;
+		}
+
+		/**
+		 * Free everything allocated from the arena, including its blocks.
+		 */
+		void release() {
+			for(auto& block: blocks)
+				free(block.data);
+			blocks.clear();
+			offset = used_bytes = 0;
+			last = nullptr;
+		}
+
+		/**
+		 * Get the number of bytes handed out, and the number reserved from the system.
+		 */
+		inline size_t used() const { return used_bytes; }
+		inline size_t capacity() const {
+			size_t total = 0;
+			for(auto& block: blocks) total += block.size;
+			return total;
+		}
+	};
+
+	namespace detail {
+		inline Allocator*& current_allocator_slot() {
+			thread_local Allocator* current = nullptr;
+			return current;
+		}
+	}
+
+	/**
+	 * Get the allocator tree-sitter allocations on this thread currently use.
+	 */
+	inline Allocator& current_allocator() {
+		Allocator* current = detail::current_allocator_slot();
+		return current ? *current : MallocAllocator::instance();
+	}
+
+	/**
+	 * Installs an allocator for the calling thread until the scope ends, ex:
+	 *
+	 *   ts::ArenaAllocator arena;
+	 *   {
+	 *       ts::AllocatorScope scope(arena);
+	 *       ts::Parser parser(ts::cpp::language());
+	 *       for(auto& file: files) index(parser.parse_string(file));
+	 *   } // The parser and every tree are gone before the arena is reset
+	 *   arena.reset();
+	 *
+	 * Everything tree-sitter allocates while the scope is active belongs to the
+	 * allocator, so with an `ArenaAllocator` the parser, its trees and any copies
+	 * of them must be created and destroyed inside the scope, on this thread.
+	 *
+	 * Scopes nest, the previous allocator is restored when a scope ends.
+	 */
+	struct AllocatorScope {
+		Allocator* previous;
+
+		explicit AllocatorScope(Allocator& allocator) : previous(detail::current_allocator_slot()) { detail::current_allocator_slot() = &allocator; }
+		AllocatorScope(const AllocatorScope&) = delete;
+		AllocatorScope& operator=(const AllocatorScope&) = delete;
+		~AllocatorScope() { detail::current_allocator_slot() = previous; }
+	};
+
+	namespace detail {
+		// Stored in front of every hooked allocation, padded to keep the allocation aligned
+		struct alignas(std::max_align_t) AllocationHeader {
+			Allocator* owner;
+			size_t size;
+		};
+
+		inline AllocationHeader* allocation_header(void* memory) { return (AllocationHeader*)memory - 1; }
+
+		inline void* hooked_allocate(size_t size) {
+			Allocator& owner = current_allocator();
+			auto* header = (AllocationHeader*)owner.allocate(sizeof(AllocationHeader) + size);
+			if(!header) return nullptr;
+			*header = {&owner, size};
+			return header + 1;
+		}
+
+		inline void hooked_free(void* memory) {
+			if(!memory) return;
+			AllocationHeader* header = allocation_header(memory);
+			header->owner->deallocate(header, sizeof(AllocationHeader) + header->size);
+		}
+
+		inline void* hooked_reallocate(void* memory, size_t size) {
+			if(!memory) return hooked_allocate(size);
+			// Resized memory stays with the allocator it came from
+			AllocationHeader* header = allocation_header(memory);
+			Allocator* owner = header->owner;
+			header = (AllocationHeader*)owner->reallocate(header, sizeof(AllocationHeader) + header->size, sizeof(AllocationHeader) + size);
+			if(!header) return nullptr;
+			header->size = size;
+			return header + 1;
+		}
+	}
+}
+
+#if defined(TREE_SITTERPP_ALLOCATOR_HOOKS) && defined(TREE_SITTERPP_ALLOCATOR_IMPLEMENTATION)
+// tree-sitter's allocation tracking entry points, defined in exactly one translation unit
+extern "C" {
+	void* ts_record_malloc(size_t size) { return TreeSitter::detail::hooked_allocate(size); }
+	void* ts_record_calloc(size_t count, size_t size) {
+		if(size && count > SIZE_MAX / size) return nullptr;
+		void* out = TreeSitter::detail::hooked_allocate(count * size);
+		if(out) std::memset(out, 0, count * size);
+		return out;
+	}
+	void* ts_record_realloc(void* memory, size_t size) { return TreeSitter::detail::hooked_reallocate(memory, size); }
+	void ts_record_free(void* memory) { TreeSitter::detail::hooked_free(memory); }
+	bool ts_toggle_allocation_recording(bool) { return false; }
+}
+
+	#ifdef TREE_SITTERPP_ALLOCATOR_SET_ALLOCATOR
+void TreeSitter::detail::install_allocator_hooks() {
+	static const bool installed = (ts_set_allocator(ts_record_malloc, ts_record_calloc, ts_record_realloc, ts_record_free), true);
+	(void)installed;
+}
+	#endif
+#endif
+
+#endif // __TREE_SITTERPP_ALLOCATOR_HPP__
\ No newline at end of file
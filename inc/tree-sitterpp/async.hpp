@@ -0,0 +1,260 @@
+#ifndef __TREE_SITTERPP_ASYNC_HPP__
+#define __TREE_SITTERPP_ASYNC_HPP__
+
+#include "parse_task.hpp"
+#include <algorithm>
+#include <condition_variable>
+#include <coroutine>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace TreeSitter {
+
+	/**
+	 * Anything coroutines can be scheduled on: `post(handle)` must arrange for
+	 * `handle.resume()` to be called later, on whichever thread it likes.
+	 */
+	template<typename E>
+	concept Executor = requires(E& executor, std::coroutine_handle<> handle) { executor.post(handle); };
+
+	/**
+	 * Lazily started coroutine producing a `T`. Awaiting the task starts it and
+	 * resumes the awaiter once it has produced its value.
+	 *
+	 * A task runs once, so it is either awaited or started with `start`;
+	 * starting a task twice, or awaiting one which was started and hasn't
+	 * finished, aborts the program instead of resuming the coroutine twice.
+	 *
+	 * Exceptions are not supported, a task which throws terminates the program.
+	 */
+	template<typename T>
+	struct Task {
+		struct promise_type {
+			std::optional<T> value;
+			std::coroutine_handle<> continuation;
+			bool started = false;
+
+			Task get_return_object() { return Task(std::coroutine_handle<promise_type>::from_promise(*this)); }
+			std::suspend_always initial_suspend() noexcept { return {}; }
+			void return_value(T result) { value.emplace(std::move(result)); }
+			void unhandled_exception() noexcept { std::terminate(); }
+
+			// Hands control straight back to the awaiting coroutine, if there is one
+			struct FinalAwaiter {
+				bool await_ready() noexcept { return false; }
+				std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> self) noexcept {
+					auto continuation = self.promise().continuation;
+					return continuation ? continuation : std::noop_coroutine();
+				}
+				void await_resume() noexcept { }
+			};
+			FinalAwaiter final_suspend() noexcept { return {}; }
+		};
+
+		std::coroutine_handle<promise_type> coroutine;
+
+		Task() = default;
+		explicit Task(std::coroutine_handle<promise_type> coroutine) : coroutine(coroutine) { }
+		Task(const Task&) = delete;
+		Task(Task&& move) : coroutine(std::exchange(move.coroutine, {})) { }
+		Task& operator=(const Task&) = delete;
+		Task& operator=(Task&& move) {
+			if(this != &move) {
+				if(coroutine) coroutine.destroy();
+				coroutine = std::exchange(move.coroutine, {});
+			}
+			return *this;
+		}
+		~Task() { if(coroutine) coroutine.destroy(); }
+
+		/**
+		 * Check if the task has produced its value.
+		 */
+		inline bool done() const { return coroutine && coroutine.done(); }
+
+		/**
+		 * Get the task's value, only valid once the task is `done`.
+		 */
+		inline T& result() { return *coroutine.promise().value; }
+
+		/**
+		 * Run the task on the calling thread until it first suspends. The task
+		 * must be kept alive until it is `done`.
+		 */
+		inline void start() {
+			mark_started("started");
+			coroutine.resume();
+		}
+
+		bool await_ready() const noexcept { return !coroutine || coroutine.done(); }
+		std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiter) noexcept {
+			mark_started("awaited");
+			coroutine.promise().continuation = awaiter;
+			return coroutine;
+		}
+		T await_resume() { return std::move(*coroutine.promise().value); }
+
+		// Resuming a running coroutine from a second place is a programming error
+		void mark_started(const char* how) noexcept {
+			if(std::exchange(coroutine.promise().started, true)) {
+				fprintf(stderr, "Task %s after it was already started\n", how);
+				std::abort();
+			}
+		}
+	};
+
+	namespace detail {
+		// Coroutine which starts immediately and frees itself when it finishes
+		struct DetachedTask {
+			struct promise_type {
+				DetachedTask get_return_object() { return {}; }
+				std::suspend_never initial_suspend() noexcept { return {}; }
+				std::suspend_never final_suspend() noexcept { return {}; }
+				void return_void() { }
+				void unhandled_exception() noexcept { std::terminate(); }
+			};
+		};
+
+		template<typename T, typename Callback>
+		DetachedTask run_detached(Task<T> task, Callback callback) { callback(co_await task); }
+	}
+
+	/**
+	 * Start a task without waiting for it, calling `callback(value)` (on
+	 * whichever thread the task finishes on) once it is done.
+	 */
+	template<typename T, typename Callback>
+	inline void spawn(Task<T> task, Callback callback) { detail::run_detached(std::move(task), std::move(callback)); }
+
+	/**
+	 * Awaitable which suspends the current coroutine and continues it on the given executor.
+	 */
+	template<Executor E>
+	struct ResumeOn {
+		E& executor;
+
+		bool await_ready() const noexcept { return false; }
+		void await_suspend(std::coroutine_handle<> handle) { executor.post(handle); }
+		void await_resume() const noexcept { }
+	};
+	template<Executor E>
+	inline ResumeOn<E> resume_on(E& executor) { return {executor}; }
+
+	/**
+	 * Parse the source without blocking, yielding to the executor between each
+	 * slice (see `ParseTask`) so a few threads can interleave many parses, ex:
+	 *
+	 *   ts::Tree tree = co_await ts::async_parse(pool, parser, source, stop);
+	 *
+	 * The parse only starts once the task is awaited (or started), and runs on
+	 * the executor. The returned tree is null if a stop was requested first.
+	 * The parser and source must stay alive until the task finishes, and the
+	 * parser can't be used for anything else in the meantime.
+	 */
+	template<Executor E>
+	Task<Tree> async_parse(E& executor, Parser& parser, const std::string_view source, std::stop_token stop = {},
+			const TSTree* old_tree = nullptr, std::chrono::microseconds slice = std::chrono::milliseconds(4)) {
+		ParseTask task(parser, source, old_tree);
+		task.set_stop_token(std::move(stop));
+		task.set_slice(slice);
+
+		co_await resume_on(executor);
+		while(task.step() == ParseTask::Running)
+			co_await resume_on(executor);
+		co_return task.take_tree();
+	}
+
+	/**
+	 * Executor whose coroutines are resumed from a fixed set of worker threads.
+	 * Coroutines still queued when the pool is destroyed are run first.
+	 */
+	struct ThreadPool {
+		std::mutex mutex;
+		std::condition_variable ready;
+		std::deque<std::coroutine_handle<>> queue;
+		bool stopping = false;
+		std::vector<std::jthread> threads;
+
+		explicit ThreadPool(size_t count = std::thread::hardware_concurrency()) {
+			for(size_t i = 0; i < std::max<size_t>(count, 1); i++)
+				threads.emplace_back([this] { work(); });
+		}
+		ThreadPool(const ThreadPool&) = delete;
+		ThreadPool& operator=(const ThreadPool&) = delete;
+		~ThreadPool() {
+			{
+				std::scoped_lock lock(mutex);
+				stopping = true;
+			}
+			ready.notify_all();
+			threads.clear();
+		}
+
+		void post(std::coroutine_handle<> handle) {
+			{
+				std::scoped_lock lock(mutex);
+				queue.push_back(handle);
+			}
+			ready.notify_one();
+		}
+
+		void work() {
+			while(true) {
+				std::coroutine_handle<> next;
+				{
+					std::unique_lock lock(mutex);
+					ready.wait(lock, [this] { return stopping || !queue.empty(); });
+					if(queue.empty()) return;
+					next = queue.front();
+					queue.pop_front();
+				}
+				next.resume();
+			}
+		}
+	};
+
+	/**
+	 * Executor whose coroutines are only resumed when the owner runs it, ex.
+	 * once per frame of a UI loop. Posting is thread safe.
+	 */
+	struct ManualExecutor {
+		std::mutex mutex;
+		std::deque<std::coroutine_handle<>> queue;
+
+		void post(std::coroutine_handle<> handle) {
+			std::scoped_lock lock(mutex);
+			queue.push_back(handle);
+		}
+
+		/**
+		 * Resume one queued coroutine, returning false if there were none.
+		 */
+		bool run_one() {
+			std::coroutine_handle<> next;
+			{
+				std::scoped_lock lock(mutex);
+				if(queue.empty()) return false;
+				next = queue.front();
+				queue.pop_front();
+			}
+			next.resume();
+			return true;
+		}
+
+		/**
+		 * Resume the queued coroutines until the queue is empty or the deadline passes.
+		 */
+		void run_until(std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max()) {
+			while(std::chrono::steady_clock::now() < deadline && run_one());
+		}
+	};
+}
+
+#endif // __TREE_SITTERPP_ASYNC_HPP__
\ No newline at end of file
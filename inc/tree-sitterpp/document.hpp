@@ -0,0 +1,240 @@
+#ifndef __TREE_SITTERPP_DOCUMENT_HPP__
+#define __TREE_SITTERPP_DOCUMENT_HPP__
+
+#include "parser.hpp"
+#include <algorithm>
+#include <string>
+#include <vector>
+
+namespace TreeSitter {
+
+	/**
+	 * A text buffer kept in sync with its syntax tree.
+	 *
+	 * The document owns its text, a parser, and the most recent tree. Edits are
+	 * applied to the text and the tree immediately, but reparsing is deferred
+	 * until the tree is next requested so bursts of edits (ex. typing) only
+	 * cost one incremental parse.
+	 *
+	 * Text is stored as a list of chunks, so an edit only rewrites the chunks
+	 * it touches instead of shifting the whole document, and the parser reads
+	 * the chunks in place.
+	 */
+	struct Document {
+		// Size that chunks are split to, chunks grow to at most twice this before being split again
+		static constexpr uint32_t chunk_size = 16 * 1024;
+
+		struct Chunk {
+			std::string text;
+			uint32_t newlines = 0;
+
+			Chunk(std::string text) : text(std::move(text)), newlines(std::count(this->text.begin(), this->text.end(), '\n')) { }
+		};
+
+		std::vector<Chunk> chunks;
+		uint32_t length = 0;
+		Parser parser;
+		Tree current_tree;
+		ChangedRanges changed;
+		bool dirty = true;
+		// The last parse was halted, the parser would resume it on the next parse
+		bool halted = false;
+
+		Document(const TSLanguage* language, const std::string_view text = {}) : parser(language) { assign(text); }
+
+		/**
+		 * Replace the document's text, the next parse will start from scratch.
+		 */
+		void assign(const std::string_view text) {
+			chunks.clear();
+			append_chunks(chunks, text);
+			if(chunks.empty()) chunks.emplace_back("");
+			length = text.size();
+			abandon_halted_parse();
+			current_tree = nullptr;
+			changed = {};
+			dirty = true;
+		}
+
+		/**
+		 * Replace `old_length` bytes starting at `start_byte` with `text`.
+		 *
+		 * The edit is applied to the current tree straight away, reparsing waits
+		 * until the tree is next requested. Returns the edit in the form tree-sitter
+		 * expects, with (row, column) positions computed from the text.
+		 */
+		TSInputEdit edit(uint32_t start_byte, uint32_t old_length, const std::string_view text) {
+			start_byte = std::min(start_byte, length);
+			old_length = std::min(old_length, length - start_byte);
+
+			TSInputEdit edit;
+			edit.start_byte = start_byte;
+			edit.old_end_byte = start_byte + old_length;
+			edit.new_end_byte = start_byte + text.size();
+			edit.start_point = point_for_byte(edit.start_byte);
+			edit.old_end_point = point_for_byte(edit.old_end_byte);
+			edit.new_end_point = advance(edit.start_point, text);
+
+			replace(start_byte, old_length, text);
+			abandon_halted_parse();
+			if(current_tree) current_tree.edit(edit);
+			dirty = true;
+			return edit;
+		}
+		inline TSInputEdit insert(uint32_t byte, const std::string_view text) { return edit(byte, 0, text); }
+		inline TSInputEdit erase(uint32_t byte, uint32_t length) { return edit(byte, length, {}); }
+
+		/**
+		 * Check if the document has been edited since it was last parsed.
+		 */
+		inline bool needs_reparse() const { return dirty; }
+
+		/**
+		 * Parse the document if it has pending edits, reusing the previous tree.
+		 *
+		 * Returns false if the parse failed (ex. it timed out), in which case the
+		 * edits stay pending and the previous (edited) tree is kept. Calling this
+		 * again without editing resumes the halted parse, editing first discards it.
+		 */
+		bool reparse() {
+			if(!dirty) return true;
+
+			Tree next = parser.parse_chunks(current_tree, chunks | std::views::transform(&Chunk::text));
+			halted = !next;
+			if(!next) return false;
+
+			changed = current_tree ? current_tree.get_changed_ranges(next) : ChangedRanges{};
+			current_tree = std::move(next);
+			dirty = false;
+			return true;
+		}
+
+		/**
+		 * Get the syntax tree for the current text, reparsing first if needed.
+		 */
+		const Tree& tree() { reparse(); return current_tree; }
+		inline const Tree& get_tree() { return tree(); }
+
+		/**
+		 * Get the ranges whose syntactic structure changed during the last reparse.
+		 */
+		inline const ChangedRanges& changed_ranges() const { return changed; }
+		inline const ChangedRanges& get_changed_ranges() const { return changed; }
+
+		/**
+		 * Get the size of the document in bytes.
+		 */
+		inline uint32_t size() const { return length; }
+
+		/**
+		 * Copy the bytes in [start, end) (by default the whole document) out of the document.
+		 */
+		std::string text(uint32_t start = 0, uint32_t end = UINT32_MAX) const {
+			end = std::min(end, length);
+			std::string out;
+			if(start >= end) return out;
+			out.reserve(end - start);
+
+			uint32_t offset = 0;
+			for(auto& chunk: chunks) {
+				uint32_t chunk_end = offset + chunk.text.size();
+				if(chunk_end > start && offset < end) {
+					uint32_t from = std::max(start, offset) - offset, to = std::min(end, chunk_end) - offset;
+					out.append(chunk.text, from, to - from);
+				}
+				offset = chunk_end;
+			}
+			return out;
+		}
+		inline std::string text(ByteRange range) const { return text(range.first, range.second); }
+
+		/**
+		 * Get the (row, column) position of the given byte offset.
+		 */
+		TSPoint point_for_byte(uint32_t byte) const {
+			auto [index, local] = locate(std::min(byte, length));
+
+			TSPoint point = {0, 0};
+			for(size_t i = 0; i < index; i++)
+				point.row += chunks[i].newlines;
+
+			const auto& text = chunks[index].text;
+			point.row += std::count(text.begin(), text.begin() + local, '\n');
+
+			// The column counts back to the last newline, which may be in an earlier chunk
+			auto line_start = local ? text.rfind('\n', local - 1) : std::string::npos;
+			if(line_start != std::string::npos) {
+				point.column = local - line_start - 1;
+				return point;
+			}
+			point.column = local;
+			for(size_t i = index; i-- > 0; ) {
+				auto newline = chunks[i].text.rfind('\n');
+				if(newline != std::string::npos) {
+					point.column += chunks[i].text.size() - newline - 1;
+					break;
+				}
+				point.column += chunks[i].text.size();
+			}
+			return point;
+		}
+
+		// A halted parse read the old text, resuming it after the text changed would mix the two
+		void abandon_halted_parse() {
+			if(!halted) return;
+			parser.reset();
+			halted = false;
+		}
+
+		// Finds the chunk containing `byte` and the offset within it, the end of the document is in the last chunk
+		std::pair<size_t, uint32_t> locate(uint32_t byte) const {
+			uint32_t offset = 0;
+			for(size_t i = 0; i + 1 < chunks.size(); i++) {
+				if(byte < offset + chunks[i].text.size()) return {i, byte - offset};
+				offset += chunks[i].text.size();
+			}
+			return {chunks.size() - 1, byte - offset};
+		}
+
+		// Rewrites the chunks covering [start, start + old_length) with the new text
+		void replace(uint32_t start, uint32_t old_length, const std::string_view text) {
+			auto [first, first_local] = locate(start);
+			auto [last, last_local] = locate(start + old_length);
+
+			std::string merged;
+			merged.reserve(first_local + text.size() + chunks[last].text.size() - last_local);
+			merged.append(chunks[first].text, 0, first_local);
+			merged.append(text);
+			merged.append(chunks[last].text, last_local);
+
+			std::vector<Chunk> replacement;
+			if(merged.size() > 2 * chunk_size) append_chunks(replacement, merged);
+			else if(!merged.empty()) replacement.emplace_back(std::move(merged));
+
+			chunks.erase(chunks.begin() + first, chunks.begin() + last + 1);
+			chunks.insert(chunks.begin() + first, std::make_move_iterator(replacement.begin()), std::make_move_iterator(replacement.end()));
+			if(chunks.empty()) chunks.emplace_back("");
+			length = length - old_length + text.size();
+		}
+
+		static void append_chunks(std::vector<Chunk>& chunks, const std::string_view text) {
+			for(size_t i = 0; i < text.size(); i += chunk_size)
+				chunks.emplace_back(std::string(text.substr(i, chunk_size)));
+		}
+
+		// Moves a point past the given text
+		static TSPoint advance(TSPoint point, const std::string_view text) {
+			auto newline = text.rfind('\n');
+			if(newline == std::string_view::npos) {
+				point.column += text.size();
+				return point;
+			}
+			point.row += std::count(text.begin(), text.end(), '\n');
+			point.column = text.size() - newline - 1;
+			return point;
+		}
+	};
+
+}
+
+#endif // __TREE_SITTERPP_DOCUMENT_HPP__
\ No newline at end of file
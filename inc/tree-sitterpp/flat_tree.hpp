@@ -0,0 +1,222 @@
+#ifndef __TREE_SITTERPP_FLAT_TREE_HPP__
+#define __TREE_SITTERPP_FLAT_TREE_HPP__
+
+#include "tree.hpp"
+#include "tree_cursor.hpp"
+#include <iterator>
+#include <ranges>
+#include <vector>
+
+namespace TreeSitter {
+
+	// Per node flags stored by a flat tree
+	enum FlatNodeFlags : uint8_t {
+		FlatNodeNamed = 1 << 0,
+		FlatNodeMissing = 1 << 1,
+		FlatNodeExtra = 1 << 2,
+		FlatNodeHasError = 1 << 3,
+	};
+
+	namespace detail {
+		// Forward iterator following a chain of next sibling links through a flat tree
+		struct SiblingIterator {
+			using value_type = uint32_t;
+			using difference_type = std::ptrdiff_t;
+
+			const uint32_t* next_siblings = nullptr;
+			uint32_t current = UINT32_MAX;
+
+			inline uint32_t operator*() const { return current; }
+			inline SiblingIterator& operator++() { current = next_siblings[current]; return *this; }
+			inline SiblingIterator operator++(int) { auto copy = *this; ++*this; return copy; }
+			inline bool operator==(const SiblingIterator& other) const { return current == other.current; }
+			inline friend bool operator==(const SiblingIterator& it, std::default_sentinel_t) { return it.current == UINT32_MAX; }
+		};
+	}
+
+	/**
+	 * Read only view of a flattened tree.
+	 *
+	 * Nodes are numbered in preorder, so node 0 is the root and the descendants
+	 * of node `i` are exactly the nodes in [i + 1, subtree_end(i)). Each property
+	 * of the nodes is stored in its own contiguous column (structure of arrays),
+	 * so scanning one property over many nodes touches only that property's
+	 * memory. Missing links (the root's parent, a leaf's first child, ...) are
+	 * `FlatTreeView::none`.
+	 */
+	struct FlatTreeView {
+		static constexpr uint32_t none = UINT32_MAX;
+
+		std::span<const TSSymbol> symbols;
+		std::span<const TSFieldId> field_ids;
+		std::span<const uint8_t> flags;
+		std::span<const uint32_t> start_bytes;
+		std::span<const uint32_t> end_bytes;
+		std::span<const TSPoint> start_points;
+		std::span<const TSPoint> end_points;
+		std::span<const uint32_t> parents;
+		std::span<const uint32_t> first_children;
+		std::span<const uint32_t> next_siblings;
+		std::span<const uint32_t> subtree_ends;
+
+		/**
+		 * Get the number of nodes in the tree.
+		 */
+		inline uint32_t size() const { return symbols.size(); }
+		inline bool empty() const { return symbols.empty(); }
+
+		/**
+		 * Get the properties of the node at the given index, see the matching `Node` functions.
+		 */
+		inline TSSymbol symbol(uint32_t i) const { return symbols[i]; }
+		inline TSFieldId field_id(uint32_t i) const { return field_ids[i]; }
+		inline uint32_t start_byte(uint32_t i) const { return start_bytes[i]; }
+		inline uint32_t end_byte(uint32_t i) const { return end_bytes[i]; }
+		inline TSPoint start_point(uint32_t i) const { return start_points[i]; }
+		inline TSPoint end_point(uint32_t i) const { return end_points[i]; }
+		inline ByteRange byte_range(uint32_t i) const { return { start_bytes[i], end_bytes[i] }; }
+		inline PointRange point_range(uint32_t i) const { return { start_points[i], end_points[i] }; }
+		inline TSRange range(uint32_t i) const { return { start_points[i], end_points[i], start_bytes[i], end_bytes[i] }; }
+		inline bool is_named(uint32_t i) const { return flags[i] & FlatNodeNamed; }
+		inline bool is_missing(uint32_t i) const { return flags[i] & FlatNodeMissing; }
+		inline bool is_extra(uint32_t i) const { return flags[i] & FlatNodeExtra; }
+		inline bool has_error(uint32_t i) const { return flags[i] & FlatNodeHasError; }
+		inline std::string_view text(uint32_t i, const std::string_view source) const { return source.substr(start_bytes[i], end_bytes[i] - start_bytes[i]); }
+
+		/**
+		 * Get the structural neighbours of the node at the given index. These are
+		 * all array lookups.
+		 */
+		inline uint32_t parent(uint32_t i) const { return parents[i]; }
+		inline uint32_t first_child(uint32_t i) const { return first_children[i]; }
+		inline uint32_t next_sibling(uint32_t i) const { return next_siblings[i]; }
+
+		/**
+		 * Get one past the index of the node's last descendant.
+		 */
+		inline uint32_t subtree_end(uint32_t i) const { return subtree_ends[i]; }
+
+		/**
+		 * Get the indices of the node's descendants (not including the node itself).
+		 */
+		inline auto descendants(uint32_t i) const { return std::views::iota(i + 1, subtree_ends[i]); }
+
+		/**
+		 * Get the indices of the node's children.
+		 */
+		inline std::ranges::subrange<detail::SiblingIterator, std::default_sentinel_t> children(uint32_t i) const { return {detail::SiblingIterator{next_siblings.data(), first_children[i]}, std::default_sentinel}; }
+
+		/**
+		 * Find the `Node` which corresponds to the given index, `root` must be the
+		 * node the flat tree was built from.
+		 *
+		 * This walks down from the root so it costs O(depth * siblings), prefer to
+		 * stay within the flat tree in hot loops.
+		 */
+		Node node(uint32_t i, const Node& root) const {
+			std::vector<uint32_t> path;
+			for(uint32_t n = i; n != 0 && n != none; n = parents[n])
+				path.push_back(n);
+
+			TreeCursor cursor(root);
+			for(auto n = path.rbegin(); n != path.rend(); n++) {
+				cursor.goto_first_child();
+				for(uint32_t sibling = first_children[parents[*n]]; sibling != *n; sibling = next_siblings[sibling])
+					cursor.goto_next_sibling();
+			}
+			return cursor.current_node();
+		}
+	};
+
+	/**
+	 * A tree flattened into contiguous arrays (see `FlatTreeView`), built with
+	 * a single cursor walk of the tree.
+	 */
+	struct FlatTree : FlatTreeView {
+		struct Columns {
+			std::vector<TSSymbol> symbols;
+			std::vector<TSFieldId> field_ids;
+			std::vector<uint8_t> flags;
+			std::vector<uint32_t> start_bytes;
+			std::vector<uint32_t> end_bytes;
+			std::vector<TSPoint> start_points;
+			std::vector<TSPoint> end_points;
+			std::vector<uint32_t> parents;
+			std::vector<uint32_t> first_children;
+			std::vector<uint32_t> next_siblings;
+			std::vector<uint32_t> subtree_ends;
+		} columns;
+
+		FlatTree() = default;
+		explicit FlatTree(const Tree& tree) : FlatTree(tree.root_node()) { }
+		explicit FlatTree(const Node& root) { build(root); }
+		FlatTree(const FlatTree& copy) : FlatTreeView(), columns(copy.columns) { bind(); }
+		FlatTree(FlatTree&&) = default;
+		FlatTree& operator=(const FlatTree& copy) { columns = copy.columns; bind(); return *this; }
+		FlatTree& operator=(FlatTree&&) = default;
+
+		/**
+		 * Rebuild the flat tree from the given node and its descendants.
+		 */
+		void build(const Node& root) {
+			columns = {};
+			if(!root.is_null()) {
+				// Each entry is an ancestor of the current node and the last child of it seen so far
+				std::vector<std::pair<uint32_t, uint32_t>> ancestors;
+				TreeCursor cursor(root);
+				while(true) {
+					uint32_t parent = ancestors.empty() ? none : ancestors.back().first;
+					uint32_t i = append(cursor.current_node(), parent, cursor.current_field_id());
+					if(!ancestors.empty()) {
+						auto& last = ancestors.back().second;
+						(last == none ? columns.first_children[parent] : columns.next_siblings[last]) = i;
+						last = i;
+					}
+
+					if(cursor.goto_first_child()) {
+						ancestors.push_back({i, none});
+						continue;
+					}
+
+					columns.subtree_ends[i] = i + 1;
+					bool finished = false;
+					while(!finished && !cursor.goto_next_sibling()) {
+						if(ancestors.empty() || !cursor.goto_parent()) finished = true;
+						else {
+							columns.subtree_ends[ancestors.back().first] = columns.symbols.size();
+							ancestors.pop_back();
+						}
+					}
+					if(finished) break;
+				}
+			}
+			bind();
+		}
+
+		uint32_t append(const Node& node, uint32_t parent, TSFieldId field) {
+			auto& c = columns;
+			c.symbols.push_back(node.symbol());
+			c.field_ids.push_back(field);
+			c.flags.push_back((node.is_named() ? FlatNodeNamed : 0) | (node.is_missing() ? FlatNodeMissing : 0)
+				| (node.is_extra() ? FlatNodeExtra : 0) | (node.has_error() ? FlatNodeHasError : 0));
+			c.start_bytes.push_back(node.start_byte());
+			c.end_bytes.push_back(node.end_byte());
+			c.start_points.push_back(node.start_point());
+			c.end_points.push_back(node.end_point());
+			c.parents.push_back(parent);
+			c.first_children.push_back(none);
+			c.next_siblings.push_back(none);
+			c.subtree_ends.push_back(none);
+			return c.symbols.size() - 1;
+		}
+
+		// Points the view at the columns
+		void bind() {
+			auto& c = columns;
+			FlatTreeView::operator=({c.symbols, c.field_ids, c.flags, c.start_bytes, c.end_bytes, c.start_points, c.end_points,
+				c.parents, c.first_children, c.next_siblings, c.subtree_ends});
+		}
+	};
+}
+
+#endif // __TREE_SITTERPP_FLAT_TREE_HPP__
\ No newline at end of file
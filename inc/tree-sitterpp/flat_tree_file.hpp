@@ -0,0 +1,211 @@
+#ifndef __TREE_SITTERPP_FLAT_TREE_FILE_HPP__
+#define __TREE_SITTERPP_FLAT_TREE_FILE_HPP__
+
+#include "flat_tree.hpp"
+#include "hash.hpp"
+#include "language.hpp"
+#include "mapped_file.hpp"
+#include <array>
+#include <filesystem>
+#include <fstream>
+#include <ostream>
+
+namespace TreeSitter {
+
+	/**
+	 * Header at the start of a serialized flat tree.
+	 *
+	 * The file is the header followed by each `FlatTreeView` column as a raw
+	 * array, in declaration order, each starting at an 8 byte aligned offset.
+	 * Values are stored in the writer's byte order; a reader with a different
+	 * byte order sees a bad magic number and rejects the file.
+	 */
+	struct FlatTreeFileHeader {
+		static constexpr uint32_t expected_magic = 0x46505354; // "TSPF" when little endian
+		static constexpr uint32_t current_format_version = 1;
+		static constexpr size_t column_count = 11;
+
+		uint32_t magic = expected_magic;
+		uint32_t format_version = current_format_version;
+		uint32_t language_version = 0;
+		uint32_t language_symbol_count = 0;
+		uint64_t content_hash = 0;
+		uint32_t node_count = 0;
+		uint32_t reserved = 0;
+		// Byte offset of each column from the start of the file
+		std::array<uint64_t, column_count> column_offsets{};
+	};
+
+	namespace detail {
+		constexpr uint64_t align_column(uint64_t offset) { return (offset + 7) & ~uint64_t(7); }
+
+		// Calls `f(column)` for each column of the view, in file order
+		template<typename F>
+		void for_each_column(const FlatTreeView& tree, F&& f) {
+			f(tree.symbols); f(tree.field_ids); f(tree.flags); f(tree.start_bytes); f(tree.end_bytes);
+			f(tree.start_points); f(tree.end_points); f(tree.parents); f(tree.first_children);
+			f(tree.next_siblings); f(tree.subtree_ends);
+		}
+		template<typename F>
+		void for_each_column(FlatTreeView& tree, F&& f) {
+			f(tree.symbols); f(tree.field_ids); f(tree.flags); f(tree.start_bytes); f(tree.end_bytes);
+			f(tree.start_points); f(tree.end_points); f(tree.parents); f(tree.first_children);
+			f(tree.next_siblings); f(tree.subtree_ends);
+		}
+	}
+
+	/**
+	 * Write a flat tree to the stream in the format described by
+	 * `FlatTreeFileHeader`. `content_hash` should identify the source the tree
+	 * was parsed from (ex. `hash_bytes(source)`) so stale files can be detected
+	 * when they are loaded.
+	 *
+	 * Returns false if writing to the stream failed.
+	 */
+	inline bool write_flat_tree(std::ostream& out, const FlatTreeView& tree, const Language& language, uint64_t content_hash) {
+		FlatTreeFileHeader header;
+		header.language_version = language.version();
+		header.language_symbol_count = language.symbol_count();
+		header.content_hash = content_hash;
+		header.node_count = tree.size();
+
+		uint64_t offset = detail::align_column(sizeof(header));
+		size_t column = 0;
+		detail::for_each_column(tree, [&](auto span) {
+			header.column_offsets[column++] = offset;
+			offset = detail::align_column(offset + span.size_bytes());
+		});
+
+		const char padding[8] = {};
+		uint64_t written = 0;
+		auto write = [&](const void* data, uint64_t size) {
+			out.write((const char*)data, size);
+			written += size;
+		};
+		write(&header, sizeof(header));
+		column = 0;
+		detail::for_each_column(tree, [&](auto span) {
+			write(padding, header.column_offsets[column++] - written);
+			write(span.data(), span.size_bytes());
+		});
+		return (bool)out;
+	}
+
+	/**
+	 * Write a flat tree to the given file, see `write_flat_tree`.
+	 */
+	inline bool save_flat_tree(const std::filesystem::path& path, const FlatTreeView& tree, const Language& language, uint64_t content_hash) {
+		std::ofstream file(path, std::ios::binary | std::ios::trunc);
+		return file && write_flat_tree(file, tree, language, content_hash) && file.flush();
+	}
+
+	/**
+	 * Flat tree loaded from a file written by `write_flat_tree`.
+	 *
+	 * The file is memory mapped and the view's columns point straight into the
+	 * mapping, so the node properties are paged in as they are queried. Opening
+	 * it validates the header and makes one O(n) pass over the structural
+	 * columns (parents, children, siblings and subtree ends), so a corrupt or
+	 * truncated file is rejected instead of indexing out of bounds later.
+	 */
+	struct MappedFlatTree : FlatTreeView {
+		MappedFile file;
+		FlatTreeFileHeader header;
+
+		MappedFlatTree() = default;
+		explicit MappedFlatTree(const std::filesystem::path& path) { open(path); }
+		MappedFlatTree(const MappedFlatTree&) = delete;
+		MappedFlatTree(MappedFlatTree&& move) { *this = std::move(move); }
+		MappedFlatTree& operator=(const MappedFlatTree&) = delete;
+		MappedFlatTree& operator=(MappedFlatTree&& move) {
+			if(this == &move) return *this;
+			file = std::move(move.file);
+			header = move.header;
+			move.close();
+			// The columns are bound again since a file read into memory may have moved
+			if(!file || !bind()) close();
+			return *this;
+		}
+
+		/**
+		 * Check if a valid flat tree was loaded.
+		 */
+		inline explicit operator bool() const { return file.is_open(); }
+		inline bool is_open() const { return file.is_open(); }
+
+		/**
+		 * Get the content hash and language version the tree was saved with.
+		 */
+		inline uint64_t content_hash() const { return header.content_hash; }
+		inline uint64_t get_content_hash() const { return content_hash(); }
+		inline uint32_t language_version() const { return header.language_version; }
+		inline uint32_t get_language_version() const { return language_version(); }
+
+		/**
+		 * Check if the tree was saved from the given source hash by a compatible
+		 * language, in which case it can be used instead of parsing the source.
+		 */
+		inline bool matches(uint64_t content_hash, const Language& language) const {
+			return is_open() && header.content_hash == content_hash
+				&& header.language_version == language.version() && header.language_symbol_count == language.symbol_count();
+		}
+		inline bool matches(const std::string_view source, const Language& language) const { return matches(hash_bytes(source), language); }
+
+		/**
+		 * Open the given file, closing the current file first.
+		 *
+		 * Returns false if the file can't be read, was written by a different
+		 * format version or byte order, or is truncated.
+		 */
+		bool open(const std::filesystem::path& path) {
+			close();
+			if(!file.open(path) || !bind()) {
+				close();
+				return false;
+			}
+			return true;
+		}
+
+		void close() {
+			file.close();
+			header = {};
+			FlatTreeView::operator=({});
+		}
+
+		// Validates the header and points the view's columns into the file
+		bool bind() {
+			if(file.size() < sizeof(header)) return false;
+			std::memcpy(&header, file.data, sizeof(header));
+			if(header.magic != FlatTreeFileHeader::expected_magic || header.format_version != FlatTreeFileHeader::current_format_version)
+				return false;
+
+			bool valid = true;
+			size_t column = 0;
+			detail::for_each_column(*this, [&](auto& span) {
+				using T = typename std::remove_reference_t<decltype(span)>::element_type;
+				uint64_t offset = header.column_offsets[column++];
+				if(offset % alignof(T) != 0 || offset > file.size() || (file.size() - offset) / sizeof(T) < header.node_count) {
+					valid = false;
+					return;
+				}
+				span = {(T*)(file.data + offset), header.node_count};
+			});
+			return valid && valid_links();
+		}
+
+		// Checks every structural link points forward in preorder (or backwards to
+		// the parent) and stays within the tree, so walking the links always terminates
+		bool valid_links() const {
+			const uint32_t count = header.node_count;
+			for(uint32_t i = 0; i < count; i++) {
+				if(i == 0 ? parents[i] != none : parents[i] >= i) return false;
+				if(subtree_ends[i] <= i || subtree_ends[i] > count) return false;
+				if(first_children[i] != none && (first_children[i] != i + 1 || first_children[i] >= subtree_ends[i])) return false;
+				if(next_siblings[i] != none && (next_siblings[i] != subtree_ends[i] || next_siblings[i] >= count)) return false;
+			}
+			return true;
+		}
+	};
+}
+
+#endif // __TREE_SITTERPP_FLAT_TREE_FILE_HPP__
\ No newline at end of file
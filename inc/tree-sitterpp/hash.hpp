@@ -0,0 +1,59 @@
+#ifndef __TREE_SITTERPP_HASH_HPP__
+#define __TREE_SITTERPP_HASH_HPP__
+
+#include "helpers.hpp"
+#include <cstring>
+#include <string_view>
+
+namespace TreeSitter {
+	namespace detail {
+		// Multiplies two 64 bit numbers and folds the 128 bit product back into 64 bits
+		inline uint64_t fold_multiply(uint64_t a, uint64_t b) {
+#ifdef __SIZEOF_INT128__
+			__uint128_t product = (__uint128_t)a * b;
+			return (uint64_t)product ^ (uint64_t)(product >> 64);
+#else
+			uint64_t a_lo = (uint32_t)a, a_hi = a >> 32, b_lo = (uint32_t)b, b_hi = b >> 32;
+			uint64_t lo_lo = a_lo * b_lo, hi_lo = a_hi * b_lo, lo_hi = a_lo * b_hi, hi_hi = a_hi * b_hi;
+			uint64_t cross = (lo_lo >> 32) + (uint32_t)hi_lo + lo_hi;
+			uint64_t upper = hi_hi + (hi_lo >> 32) + (cross >> 32);
+			return ((cross << 32) | (uint32_t)lo_lo) ^ upper;
+#endif
+		}
+
+		inline uint64_t read64(const char* p) { uint64_t v; std::memcpy(&v, p, 8); return v; }
+		inline uint64_t read32(const char* p) { uint32_t v; std::memcpy(&v, p, 4); return v; }
+	}
+
+	/**
+	 * Fast non-cryptographic 64 bit hash of a byte string (a multiply-fold hash
+	 * in the style of wyhash), suitable for detecting unchanged source files and
+	 * keying caches. Not suitable where an adversary controls the input.
+	 */
+	inline uint64_t hash_bytes(const std::string_view bytes, uint64_t seed = 0) {
+		constexpr uint64_t p0 = 0xa0761d6478bd642full, p1 = 0xe7037ed1a0b428dbull, p2 = 0x8ebc6af09c88c6e3ull;
+		const char* p = bytes.data();
+		size_t length = bytes.size();
+
+		uint64_t h = seed ^ p0;
+		size_t i = 0;
+		for(; i + 16 <= length; i += 16)
+			h = detail::fold_multiply(detail::read64(p + i) ^ p1, detail::read64(p + i + 8) ^ h);
+
+		// Fold in the remaining 0-15 bytes
+		uint64_t a = 0, b = 0;
+		size_t rest = length - i;
+		if(rest >= 8) {
+			a = detail::read64(p + i);
+			b = detail::read64(p + length - 8);
+		} else if(rest >= 4) {
+			a = detail::read32(p + i);
+			b = detail::read32(p + length - 4);
+		} else if(rest > 0)
+			a = ((uint64_t)(uint8_t)p[i] << 16) | ((uint64_t)(uint8_t)p[i + rest / 2] << 8) | (uint8_t)p[length - 1];
+
+		return detail::fold_multiply(h ^ p2 ^ length, detail::fold_multiply(a ^ p1, b ^ h));
+	}
+}
+
+#endif // __TREE_SITTERPP_HASH_HPP__
\ No newline at end of file
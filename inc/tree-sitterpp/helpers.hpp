@@ -2,16 +2,45 @@
 #define __TREE_SITTERPP_DELETER_HPP__
 
 #include <tree_sitter/api.h>
+#include <cstdlib>
 #include <memory>
 #include <span>
 
+#ifdef TREE_SITTERPP_ALLOCATOR_HOOKS
+extern "C" void ts_record_free(void*);
+#endif
+
 namespace TreeSitter {
 	namespace detail {
+#ifdef TREE_SITTERPP_ALLOCATOR_SET_ALLOCATOR
+		// Installs the allocator hooks with `ts_set_allocator`, see allocator.hpp
+		void install_allocator_hooks();
+#endif
+
+		// Newer tree-sitter takes the allocator hooks at runtime, they must be installed before it allocates anything
+		inline void ensure_allocator_hooks() {
+#ifdef TREE_SITTERPP_ALLOCATOR_SET_ALLOCATOR
+			install_allocator_hooks();
+#endif
+		}
+
+		// Frees memory tree-sitter allocated for the caller, which came from the allocator hooks if they are enabled
+		inline void free_ts_memory(void* memory) {
+#ifdef TREE_SITTERPP_ALLOCATOR_HOOKS
+			ts_record_free(memory);
+#else
+			free(memory);
+#endif
+		}
+
 		// Struct that includes functions specifying how to delete managed types
 		struct Deleter {
 			void operator()(TSParser* del) { if(del) ts_parser_delete(del); }
 			void operator()(TSTree* del) { if(del) ts_tree_delete(del); }
 			void operator()(TSTreeCursor* del) { if(del) ts_tree_cursor_delete(del); }
+			void operator()(TSQuery* del) { if(del) ts_query_delete(del); }
+			void operator()(TSQueryCursor* del) { if(del) ts_query_cursor_delete(del); }
+			void operator()(TSRange* del) { free_ts_memory(del); }
 		};
 
 		// A UniqueHandle is a unique_ptr that uses the ts_ deleters
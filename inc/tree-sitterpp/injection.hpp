@@ -0,0 +1,615 @@
+#ifndef __TREE_SITTERPP_INJECTION_HPP__
+#define __TREE_SITTERPP_INJECTION_HPP__
+
+#include "language_registry.hpp"
+#include "parallel_parser.hpp"
+#include "parser.hpp"
+#include "query.hpp"
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace TreeSitter {
+
+	/**
+	 * A region of a layer's text which should be parsed as another language.
+	 */
+	struct InjectionSite {
+		std::string language;        // Resolved by the `LayeredParser`'s language resolver
+		std::vector<TSRange> ranges; // In document order, see `content_ranges`
+		bool combined = false;       // Parse together with the layer's other combined sites for the same language
+	};
+
+	/**
+	 * Pool of parsers which are handed out and returned, so parsing many small
+	 * layers doesn't create a parser (and its stacks and lexer buffers) for each.
+	 * Acquiring and releasing are thread safe.
+	 */
+	struct ParserPool {
+		std::mutex mutex;
+		std::vector<Parser> idle;
+
+		Parser acquire() {
+			std::scoped_lock lock(mutex);
+			if(idle.empty()) return {};
+			Parser parser = std::move(idle.back());
+			idle.pop_back();
+			return parser;
+		}
+
+		void release(Parser parser) {
+			parser.reset();
+			std::scoped_lock lock(mutex);
+			idle.push_back(std::move(parser));
+		}
+	};
+
+	namespace detail {
+		// Moves a position past an edit the same way `ts_tree_edit` does
+		inline void edit_position(uint32_t& byte, TSPoint& point, const TSInputEdit& edit) {
+			if(byte >= edit.old_end_byte) {
+				byte = byte - edit.old_end_byte + edit.new_end_byte;
+				if(point.row == edit.old_end_point.row) point.column = point.column - edit.old_end_point.column + edit.new_end_point.column;
+				point.row = point.row - edit.old_end_point.row + edit.new_end_point.row;
+			} else if(byte > edit.start_byte) {
+				byte = edit.new_end_byte;
+				point = edit.new_end_point;
+			}
+		}
+
+		inline void edit_range(TSRange& range, const TSInputEdit& edit) {
+			edit_position(range.start_byte, range.start_point, edit);
+			edit_position(range.end_byte, range.end_point, edit);
+		}
+
+		// Touching counts as intersecting, so insertions at a range's edges are noticed
+		inline bool touches(const std::vector<TSRange>& ranges, uint32_t start, uint32_t end) {
+			if(ranges.empty()) return true; // The whole document
+			for(auto& range: ranges)
+				if(start <= range.end_byte && end >= range.start_byte) return true;
+			return false;
+		}
+
+		// Whether any of the ranges touch any of the others, an empty list is nothing here rather than the whole document
+		inline bool overlaps(const std::vector<TSRange>& a, const std::vector<TSRange>& b) {
+			if(a.empty()) return false;
+			for(auto& range: b)
+				if(touches(a, range.start_byte, range.end_byte)) return true;
+			return false;
+		}
+
+		inline bool same_bytes(const std::vector<TSRange>& a, const std::vector<TSRange>& b) {
+			return std::equal(a.begin(), a.end(), b.begin(), b.end(), [](const TSRange& a, const TSRange& b) {
+				return a.start_byte == b.start_byte && a.end_byte == b.end_byte;
+			});
+		}
+
+		// Clips ranges (in document order) to a layer's included ranges, an empty layer range list is the whole document
+		inline std::vector<TSRange> clip_ranges(const std::vector<TSRange>& ranges, const std::vector<TSRange>& bounds) {
+			if(bounds.empty()) return ranges;
+			std::vector<TSRange> out;
+			for(auto& range: ranges)
+				for(auto& bound: bounds) {
+					if(bound.end_byte <= range.start_byte) continue;
+					if(bound.start_byte >= range.end_byte) break;
+					TSRange clipped = range;
+					if(bound.start_byte > clipped.start_byte) { clipped.start_byte = bound.start_byte; clipped.start_point = bound.start_point; }
+					if(bound.end_byte < clipped.end_byte) { clipped.end_byte = bound.end_byte; clipped.end_point = bound.end_point; }
+					out.push_back(clipped);
+				}
+			return out;
+		}
+	}
+
+	/**
+	 * Get the ranges of text a node covers, without the text of its children
+	 * unless `include_children` is set (ex. a string literal's escape sequences
+	 * are left out of an injected language's text).
+	 */
+	inline std::vector<TSRange> content_ranges(const Node& node, bool include_children = false) {
+		TSRange range = node.range();
+		if(include_children) return {range};
+
+		std::vector<TSRange> out;
+		TSRange gap = range;
+		for(uint32_t i = 0, count = node.child_count(); i < count; i++) {
+			Node child = node.child(i);
+			gap.end_byte = child.start_byte();
+			gap.end_point = child.start_point();
+			if(gap.end_byte > gap.start_byte) out.push_back(gap);
+			gap.start_byte = child.end_byte();
+			gap.start_point = child.end_point();
+		}
+		gap.end_byte = range.end_byte;
+		gap.end_point = range.end_point;
+		if(gap.end_byte > gap.start_byte) out.push_back(gap);
+		return out;
+	}
+
+	/**
+	 * Parses a document containing other languages (ex. SQL in string literals,
+	 * assembly blocks, markup in doc comments) into a tree of layers.
+	 *
+	 * The root layer parses the whole document. Injection sites are found in each
+	 * layer through queries (see `add_injection_query`) or callbacks (see
+	 * `add_injection_callback`), and each becomes a child layer parsed with
+	 * `Parser::set_included_ranges`. Parsers are borrowed from a pool, and
+	 * independent layers can be parsed in parallel (see `set_thread_count`).
+	 *
+	 * After `edit`, `parse` reparses incrementally: layers whose ranges the edits
+	 * didn't touch are kept as they are (their trees are just shifted), only the
+	 * layers the edits touched are reparsed (reusing their old trees), and their
+	 * injection queries only run over the ranges whose structure changed or which
+	 * were edited. Child layers outside those ranges are carried over as they
+	 * were. Layers whose injection queries have combined patterns are searched in
+	 * full, since a combined layer is built from every match in its parent.
+	 *
+	 *   ts::LayeredParser parser(ts::cpp::language());
+	 *   parser.add_injection_query(ts::cpp::language(),
+	 *       "((raw_string_literal) @injection.content (#set! injection.language \"sql\"))");
+	 *   parser.parse(source);
+	 *   ...
+	 *   parser.edit(edit);
+	 *   parser.parse(new_source);
+	 */
+	struct LayeredParser {
+		struct Layer {
+			Language language;
+			std::string language_name;
+			std::vector<TSRange> ranges; // Empty for the root layer, which covers the whole document
+			Tree tree;
+			size_t parent = -1;          // Index of the parent layer, parents come before their children
+			uint32_t depth = 0;
+			bool combined = false;
+			bool reparsed = false;       // Parsed during the last `parse` rather than kept from the one before
+			ChangedRanges changed;       // Ranges whose structure changed if the layer was reparsed incrementally
+		};
+
+		// How one query pattern's matches are turned into injection sites
+		struct PatternSettings {
+			std::string language;
+			bool combined = false;
+			bool include_children = false;
+		};
+
+		struct InjectionQuery {
+			Query query;
+			std::optional<uint32_t> content_capture, language_capture;
+			std::vector<PatternSettings> patterns;
+		};
+
+		using InjectionCallback = std::function<void(const Layer& layer, const std::string_view source, std::vector<InjectionSite>& sites)>;
+		using LanguageResolver = std::function<Language(const std::string_view name)>;
+
+		Language root_language;
+		LanguageResolver resolve_language = [](const std::string_view name) { return LanguageRegistry::global().get(name); };
+		std::unordered_map<const TSLanguage*, std::vector<InjectionQuery>> injection_queries;
+		std::vector<InjectionCallback> injection_callbacks;
+		// Injections nested deeper than this are ignored, so a language which injects itself can't recurse forever
+		uint32_t max_depth = 8;
+
+		ParserPool parsers;
+		// Set by `set_thread_count`, parses the layers of each depth concurrently
+		std::unique_ptr<ParallelParser> workers;
+		// Levels with less work than this (not counting their largest layer) are parsed on the calling thread
+		uint64_t min_parallel_bytes = 32 * 1024;
+		// Applied to every parser a layer is parsed with, see `Parser::set_timeout_micros` and `Parser::set_cancellation_flag`
+		uint64_t timeout = 0;
+		const size_t* cancellation_flag = nullptr;
+		std::vector<Layer> current_layers;
+		// Byte ranges (in the current text) touched by edits since the last parse
+		std::vector<TSRange> pending_edits;
+		bool parsed = false;
+
+		explicit LayeredParser(Language root_language) : root_language(root_language) { }
+
+		/**
+		 * Set how injected language names are turned into languages, by default
+		 * through `LanguageRegistry::global()`.
+		 */
+		inline void set_language_resolver(LanguageResolver resolver) { resolve_language = std::move(resolver); }
+
+		/**
+		 * Parse layers on up to the given number of threads (1 by default). The
+		 * layers of each depth are independent, so whenever several of them need
+		 * parsing they are parsed concurrently, largest first, each worker reusing
+		 * its own parser. A parse then takes roughly as long as the largest layer
+		 * at each depth rather than the sum of every layer.
+		 *
+		 * Worker threads are started for each level that is parsed in parallel,
+		 * so small levels (typical of reparses after an edit) stay on the calling
+		 * thread, see `set_min_parallel_bytes`.
+		 */
+		void set_thread_count(size_t threads) {
+			if(threads > 1) workers = std::make_unique<ParallelParser>(root_language, threads);
+			else workers.reset();
+		}
+		inline size_t thread_count() const { return workers ? workers->thread_count() : 1; }
+		inline size_t get_thread_count() const { return thread_count(); }
+
+		/**
+		 * Set how many bytes of layers (besides the largest one) a level needs
+		 * before it is worth starting worker threads for it, 32KiB by default.
+		 */
+		inline void set_min_parallel_bytes(uint64_t bytes) { min_parallel_bytes = bytes; }
+
+		/**
+		 * Set the longest each layer's parse may take, in microseconds (0 for no
+		 * limit). A halted layer makes `parse` return false, keeping the previous
+		 * layers and pending edits so the parse can be retried.
+		 */
+		inline void set_timeout_micros(uint64_t micros) { timeout = micros; }
+		inline uint64_t timeout_micros() const { return timeout; }
+		inline uint64_t get_timeout_micros() const { return timeout_micros(); }
+
+		/**
+		 * Set a flag which halts the parse (like a timeout) once it is non-zero.
+		 * The flag is polled by every parser, including the worker threads'.
+		 */
+		inline void set_cancellation_flag(const size_t* flag) { cancellation_flag = flag; }
+		inline const size_t* get_cancellation_flag() const { return cancellation_flag; }
+
+		/**
+		 * Add an injection query for layers of the given language, following
+		 * tree-sitter's injection query conventions:
+		 * - `@injection.content` captures the node whose text is injected.
+		 * - `@injection.language` captures a node whose text names the language,
+		 *   or the pattern sets it with `(#set! injection.language "name")`.
+		 * - `(#set! injection.combined)` parses all of the layer's matches of the
+		 *   pattern as one document, `(#set! injection.include-children)` keeps the
+		 *   content node's children's text.
+		 *
+		 * Text predicates (`#eq?`, `#match?`, ...) are not evaluated. Returns false
+		 * if the query doesn't compile.
+		 */
+		bool add_injection_query(Language language, const std::string_view source) {
+			InjectionQuery injection;
+			injection.query = Query(language, source);
+			if(!injection.query) return false;
+			injection.content_capture = injection.query.capture_index_for_name("injection.content");
+			injection.language_capture = injection.query.capture_index_for_name("injection.language");
+
+			for(uint32_t pattern = 0; pattern < injection.query.pattern_count(); pattern++) {
+				PatternSettings& settings = injection.patterns.emplace_back();
+				auto steps = injection.query.predicates_for_pattern(pattern);
+				for(size_t start = 0; start < steps.size(); ) {
+					size_t end = start;
+					while(end < steps.size() && steps[end].type != TSQueryPredicateStepTypeDone) end++;
+					auto string = [&](size_t i) { return i < end && steps[i].type == TSQueryPredicateStepTypeString ? injection.query.string_value_for_id(steps[i].value_id) : std::string_view{}; };
+					if(string(start) == "set!") {
+						auto key = string(start + 1);
+						if(key == "injection.language") settings.language = string(start + 2);
+						else if(key == "injection.combined") settings.combined = true;
+						else if(key == "injection.include-children") settings.include_children = true;
+					}
+					start = end + 1;
+				}
+			}
+			injection_queries[language].push_back(std::move(injection));
+			return true;
+		}
+
+		/**
+		 * Add a callback which appends the injection sites of any layer to `sites`.
+		 * Callbacks are called with the whole layer each time it is reparsed, unlike
+		 * queries their search isn't limited to the ranges which changed.
+		 */
+		inline void add_injection_callback(InjectionCallback callback) { injection_callbacks.push_back(std::move(callback)); }
+
+		/**
+		 * Get the layers from the last parse, the root layer is first and every
+		 * layer comes after its parent. There are none until a parse succeeds.
+		 */
+		inline const std::vector<Layer>& layers() const { return current_layers; }
+		inline const std::vector<Layer>& get_layers() const { return layers(); }
+
+		/**
+		 * Get the root layer, or null if the document hasn't been parsed yet.
+		 */
+		inline const Layer* root() const { return current_layers.empty() ? nullptr : &current_layers.front(); }
+		inline const Layer* get_root() const { return root(); }
+
+		/**
+		 * Get the deepest layer whose text includes the given byte.
+		 */
+		const Layer* layer_at(uint32_t byte) const {
+			const Layer* found = nullptr;
+			for(auto& layer: current_layers)
+				if((layer.ranges.empty() || std::any_of(layer.ranges.begin(), layer.ranges.end(), [&](auto& r) { return byte >= r.start_byte && byte < r.end_byte; }))
+						&& (!found || layer.depth > found->depth))
+					found = &layer;
+			return found;
+		}
+
+		/**
+		 * Record an edit to the document, applying it to every layer's tree and
+		 * ranges. Call `parse` with the new text afterwards.
+		 */
+		void edit(const TSInputEdit& edit) {
+			for(auto& layer: current_layers) {
+				if(layer.tree) layer.tree.edit(edit);
+				for(auto& range: layer.ranges) detail::edit_range(range, edit);
+			}
+			for(auto& range: pending_edits) detail::edit_range(range, edit);
+			pending_edits.push_back({edit.start_point, edit.new_end_point, edit.start_byte, edit.new_end_byte});
+		}
+
+		/**
+		 * Parse the document, incrementally if it was parsed before. Returns false
+		 * if a layer's parse was halted (ex. by a timeout) or the root language
+		 * can't be used, in which case the previous layers and pending edits are kept.
+		 */
+		bool parse(const std::string_view source) {
+			std::vector<Layer> next;
+			// Which previous layer each new layer continues, if any
+			std::vector<size_t> origins;
+			std::vector<std::vector<size_t>> old_children(current_layers.size());
+			for(size_t i = 1; i < current_layers.size(); i++)
+				old_children[current_layers[i].parent].push_back(i);
+
+			Layer& root = next.emplace_back();
+			root.language = root_language;
+			if(!current_layers.empty()) root.tree = current_layers.front().tree;
+			origins.push_back(parsed ? 0 : -1);
+
+			// Layers are processed a depth at a time, parsing the level and then collecting its children
+			for(size_t level = 0; level < next.size(); ) {
+				size_t level_end = next.size();
+				if(!parse_level(next, origins, level, level_end, source)) return false;
+				for(size_t i = level; i < level_end; i++)
+					if(next[i].tree) add_children(next, origins, old_children, i, source);
+				level = level_end;
+			}
+
+			// Layers whose language couldn't be set have no tree, drop them (and anything below them)
+			if(!next.front().tree) return false;
+			std::vector<size_t> index(next.size(), -1);
+			size_t kept = 0;
+			for(size_t i = 0; i < next.size(); i++)
+				if(next[i].tree && (i == 0 || index[next[i].parent] != (size_t)-1)) {
+					if(i) next[i].parent = index[next[i].parent];
+					index[i] = kept;
+					if(kept != i) next[kept] = std::move(next[i]);
+					kept++;
+				}
+			next.resize(kept);
+
+			current_layers = std::move(next);
+			pending_edits.clear();
+			parsed = true;
+			return true;
+		}
+
+		// Whether a layer carried over from the previous parse has to be reparsed
+		bool needs_parse(const Layer& layer, size_t origin) const {
+			if(!layer.tree || origin == (size_t)-1) return true;
+			if(!detail::same_bytes(layer.ranges, current_layers[origin].ranges)) return true;
+			for(auto& edit: pending_edits)
+				if(detail::touches(layer.ranges, edit.start_byte, edit.end_byte)) return true;
+			return false;
+		}
+
+		// Parses the layers in [begin, end) which need it, returns false if a parse was halted
+		bool parse_level(std::vector<Layer>& layers, const std::vector<size_t>& origins, size_t begin, size_t end, const std::string_view source) {
+			std::vector<size_t> dirty;
+			for(size_t i = begin; i < end; i++)
+				if(needs_parse(layers[i], origins[i])) dirty.push_back(i);
+
+			auto cost = [&](size_t job) {
+				const Layer& layer = layers[dirty[job]];
+				if(layer.ranges.empty()) return (uint64_t)source.size();
+				uint64_t bytes = 0;
+				for(auto& range: layer.ranges) bytes += range.end_byte - range.start_byte;
+				return bytes;
+			};
+			// Starting the workers costs more than parsing a few small layers, and the largest layer is parsed by one thread either way
+			uint64_t total = 0, largest = 0;
+			for(size_t job = 0; workers && job < dirty.size(); job++) {
+				total += cost(job);
+				largest = std::max(largest, cost(job));
+			}
+
+			if(!workers || dirty.size() < 2 || total - largest < min_parallel_bytes) {
+				for(size_t i: dirty) {
+					Parser parser = parsers.acquire();
+					bool finished = parse_layer(parser, layers[i], source);
+					parsers.release(std::move(parser));
+					if(!finished) return false;
+				}
+				return true;
+			}
+
+			// Each job only touches its own layer, the layer list isn't resized until the level is done
+			std::atomic<bool> halted = false;
+			workers->run(dirty.size(), cost, [&](Parser& parser, size_t job, size_t) {
+				// The level is abandoned once any layer halts, so the remaining layers aren't worth parsing
+				if(halted.load(std::memory_order_relaxed)) return;
+				if(!parse_layer(parser, layers[dirty[job]], source)) halted = true;
+				parser.reset();
+			});
+			return !halted;
+		}
+
+		// Parses a single layer with the given parser, a layer whose language can't be used is left without a tree
+		bool parse_layer(Parser& parser, Layer& layer, const std::string_view source) const {
+			parser.set_timeout_micros(timeout);
+			parser.set_cancellation_flag(cancellation_flag);
+			if(!parser.set_language(layer.language)) {
+				layer.tree = nullptr;
+				return true;
+			}
+			if(!layer.ranges.empty() && !parser.set_included_ranges(layer.ranges.data(), layer.ranges.size())) {
+				layer.tree = nullptr;
+				return true;
+			}
+			Tree tree = parser.parse_string(layer.tree, source);
+			parser.set_included_ranges(nullptr, 0);
+			if(!tree) return false;
+
+			layer.changed = layer.tree ? layer.tree.get_changed_ranges(tree) : ChangedRanges{};
+			layer.tree = std::move(tree);
+			layer.reparsed = true;
+			return true;
+		}
+
+		// Finds the injection sites of a layer and appends its child layers
+		void add_children(std::vector<Layer>& layers, std::vector<size_t>& origins, const std::vector<std::vector<size_t>>& old_children, size_t index, const std::string_view source) {
+			size_t origin = origins[index];
+			const std::vector<size_t> none;
+			const std::vector<size_t>& previous = origin == (size_t)-1 ? none : old_children[origin];
+
+			// A layer which wasn't reparsed has the same injections as before
+			if(!layers[index].reparsed) {
+				for(size_t old: previous) {
+					Layer& child = layers.emplace_back(copy_layer(current_layers[old]));
+					child.parent = index;
+					origins.push_back(old);
+				}
+				return;
+			}
+			if(layers[index].depth >= max_depth) return;
+
+			// A layer reparsed from its old tree only needs searching where it changed
+			const bool incremental = origin != (size_t)-1 && !has_combined_patterns(layers[index].language);
+			std::vector<TSRange> affected;
+			if(incremental) affected = affected_ranges(layers[index]);
+
+			std::vector<InjectionSite> sites = find_sites(layers[index], source, incremental ? &affected : nullptr);
+			std::vector<bool> matched(previous.size(), false);
+			std::vector<size_t> combined; // Layers created for combined sites in this parent, by language
+
+			for(auto& site: sites) {
+				site.ranges = detail::clip_ranges(site.ranges, layers[index].ranges);
+				if(site.ranges.empty()) continue;
+
+				if(site.combined) {
+					auto existing = std::find_if(combined.begin(), combined.end(), [&](size_t i) { return layers[i].language_name == site.language; });
+					if(existing != combined.end()) {
+						auto& ranges = layers[*existing].ranges;
+						ranges.insert(ranges.end(), site.ranges.begin(), site.ranges.end());
+						continue;
+					}
+				}
+
+				Language language = resolve_language(site.language);
+				if(!language) continue;
+
+				// Continue the previous layer for the same site, if there was one
+				size_t old = -1;
+				for(size_t i = 0; i < previous.size() && old == (size_t)-1; i++) {
+					const Layer& candidate = current_layers[previous[i]];
+					if(matched[i] || candidate.language_name != site.language || candidate.combined != site.combined) continue;
+					if(site.combined || detail::touches(candidate.ranges, site.ranges.front().start_byte, site.ranges.back().end_byte)) {
+						matched[i] = true;
+						old = previous[i];
+					}
+				}
+
+				Layer& child = layers.emplace_back();
+				child.language = language;
+				child.language_name = site.language;
+				child.ranges = std::move(site.ranges);
+				child.parent = index;
+				child.depth = layers[index].depth + 1;
+				child.combined = site.combined;
+				if(old != (size_t)-1) child.tree = current_layers[old].tree;
+				origins.push_back(old);
+				if(site.combined) combined.push_back(layers.size() - 1);
+			}
+
+			for(size_t i: combined)
+				std::sort(layers[i].ranges.begin(), layers[i].ranges.end(), [](auto& a, auto& b) { return a.start_byte < b.start_byte; });
+
+			// The injections outside of the affected ranges can't have changed, carry them over as they were
+			if(incremental)
+				for(size_t i = 0; i < previous.size(); i++)
+					if(!matched[i] && !detail::overlaps(affected, current_layers[previous[i]].ranges)) {
+						Layer& child = layers.emplace_back(copy_layer(current_layers[previous[i]]));
+						child.parent = index;
+						origins.push_back(previous[i]);
+					}
+		}
+
+		// The ranges of a reparsed layer whose injections may have changed: where its structure changed and where the text was edited
+		std::vector<TSRange> affected_ranges(const Layer& layer) const {
+			std::vector<TSRange> ranges(layer.changed.begin(), layer.changed.end());
+			ranges.insert(ranges.end(), pending_edits.begin(), pending_edits.end());
+			std::sort(ranges.begin(), ranges.end(), [](auto& a, auto& b) { return a.start_byte < b.start_byte; });
+
+			std::vector<TSRange> merged;
+			for(auto& range: ranges) {
+				if(!merged.empty() && range.start_byte <= merged.back().end_byte) {
+					if(range.end_byte > merged.back().end_byte) {
+						merged.back().end_byte = range.end_byte;
+						merged.back().end_point = range.end_point;
+					}
+				} else merged.push_back(range);
+			}
+			return merged;
+		}
+
+		// Whether any injection query for the language has a combined pattern
+		bool has_combined_patterns(const TSLanguage* language) const {
+			auto found = injection_queries.find(language);
+			if(found == injection_queries.end()) return false;
+			return std::any_of(found->second.begin(), found->second.end(), [](const InjectionQuery& injection) {
+				return std::any_of(injection.patterns.begin(), injection.patterns.end(), [](const PatternSettings& settings) { return settings.combined; });
+			});
+		}
+
+		// Finds a layer's injection sites, only running the queries within the given (merged) ranges if there are any
+		std::vector<InjectionSite> find_sites(const Layer& layer, const std::string_view source, const std::vector<TSRange>* within = nullptr) const {
+			std::vector<InjectionSite> sites;
+			auto found = injection_queries.find(layer.language);
+			if(found != injection_queries.end() && !(within && within->empty()))
+				for(auto& injection: found->second) {
+					if(!injection.content_capture) continue;
+					QueryCursor cursor;
+					const size_t first = sites.size();
+					for(size_t part = 0; part < (within ? within->size() : 1); part++) {
+						if(within) cursor.set_byte_range((*within)[part].start_byte, (*within)[part].end_byte);
+						for(auto& match: cursor.matches(injection.query, layer.tree.root_node())) {
+							const PatternSettings& settings = injection.patterns[match.pattern_index];
+							InjectionSite site{settings.language, {}, settings.combined};
+							for(auto& capture: match.capture_span()) {
+								Node node = capture.node;
+								if(capture.index == *injection.content_capture) {
+									auto ranges = content_ranges(node, settings.include_children);
+									site.ranges.insert(site.ranges.end(), ranges.begin(), ranges.end());
+								} else if(injection.language_capture && capture.index == *injection.language_capture)
+									site.language = source.substr(node.start_byte(), node.end_byte() - node.start_byte());
+							}
+							if(site.language.empty() || site.ranges.empty()) continue;
+							// A match spanning several of the ranges is found once for each
+							if(part && std::any_of(sites.begin() + first, sites.end(), [&](const InjectionSite& other) {
+									return other.language == site.language && detail::same_bytes(other.ranges, site.ranges); }))
+								continue;
+							sites.push_back(std::move(site));
+						}
+					}
+				}
+
+			for(auto& callback: injection_callbacks)
+				callback(layer, source, sites);
+			return sites;
+		}
+
+		static Layer copy_layer(const Layer& layer) {
+			Layer copy;
+			copy.language = layer.language;
+			copy.language_name = layer.language_name;
+			copy.ranges = layer.ranges;
+			copy.tree = layer.tree;
+			copy.depth = layer.depth;
+			copy.combined = layer.combined;
+			return copy;
+		}
+	};
+}
+
+#endif // __TREE_SITTERPP_INJECTION_HPP__
\ No newline at end of file
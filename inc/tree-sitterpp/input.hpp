@@ -0,0 +1,77 @@
+#ifndef __TREE_SITTERPP_INPUT_HPP__
+#define __TREE_SITTERPP_INPUT_HPP__
+
+#include "helpers.hpp"
+#include <concepts>
+#include <ranges>
+#include <string_view>
+
+namespace TreeSitter {
+
+	// Callable which returns the text starting at a given byte offset and position, an empty result marks the end of the document
+	template<typename F>
+	concept InputReader = std::is_invocable_r_v<std::string_view, F&, uint32_t, TSPoint>;
+
+	// Range of text chunks which together make up a document (ex. a piece table's pieces or a rope's leaves).
+	// The parser keeps a view of each chunk, so chunks must be stored in the range (or already be views),
+	// not produced as temporaries (ex. a transform returning std::string by value) which the view would outlive.
+	template<typename R>
+	concept ChunkRange = std::ranges::forward_range<R> && std::convertible_to<std::ranges::range_reference_t<R>, std::string_view>
+		&& (std::is_lvalue_reference_v<std::ranges::range_reference_t<R>> || std::same_as<std::remove_cvref_t<std::ranges::range_reference_t<R>>, std::string_view>);
+
+	/**
+	 * Wrap a reader as a `TSInput`.
+	 *
+	 * The parser borrows the returned text until its next read, so the reader
+	 * can hand out pointers into its own storage instead of copying. The reader
+	 * must outlive any parse using the input.
+	 */
+	template<InputReader F>
+	TSInput make_input(F& read, TSInputEncoding encoding = TSInputEncodingUTF8) {
+		return {(void*)&read, [](void* payload, uint32_t byte, TSPoint point, uint32_t* bytes_read) -> const char* {
+			std::string_view text = (*(F*)payload)(byte, point);
+			*bytes_read = text.size();
+			return text.data();
+		}, encoding};
+	}
+
+	/**
+	 * Reader over a range of chunks, returning the remainder of the chunk which
+	 * contains the requested byte.
+	 *
+	 * The parser reads mostly forwards so the reader remembers the last chunk it
+	 * visited and only rescans from the start when asked to go backwards.
+	 */
+	template<ChunkRange R>
+	struct ChunkedInput {
+		R chunks;
+		std::ranges::iterator_t<R> current = std::ranges::begin(chunks);
+		uint32_t offset = 0;
+
+		ChunkedInput(R chunks) : chunks(std::move(chunks)) { }
+		// The parser holds a pointer to the reader, so it stays put
+		ChunkedInput(const ChunkedInput&) = delete;
+
+		std::string_view operator()(uint32_t byte, TSPoint) {
+			if(byte < offset) {
+				current = std::ranges::begin(chunks);
+				offset = 0;
+			}
+
+			for(; current != std::ranges::end(chunks); ++current) {
+				std::string_view chunk = *current;
+				if(byte < offset + chunk.size()) return chunk.substr(byte - offset);
+				offset += chunk.size();
+			}
+			return {};
+		}
+
+		inline TSInput input(TSInputEncoding encoding = TSInputEncodingUTF8) { return make_input(*this, encoding); }
+		inline operator TSInput() { return input(); }
+	};
+
+	template<typename R>
+	ChunkedInput(R&&) -> ChunkedInput<std::views::all_t<R>>;
+}
+
+#endif // __TREE_SITTERPP_INPUT_HPP__
\ No newline at end of file
@@ -0,0 +1,259 @@
+#ifndef __TREE_SITTERPP_INSTRUMENTATION_HPP__
+#define __TREE_SITTERPP_INSTRUMENTATION_HPP__
+
+#include "parser.hpp"
+#include <algorithm>
+#include <chrono>
+#include <charconv>
+#include <string_view>
+
+namespace TreeSitter {
+
+	// Classification of the messages tree-sitter logs while parsing
+	enum class ParseEvent : uint8_t {
+		Other,
+		Lex,             // The lexer started scanning a token (internal or external scanner)
+		LexedLookahead,  // The lexer produced a token
+		ConsumeCharacter,
+		SkipCharacter,
+		Process,         // A stack version is about to process the lookahead
+		Shift,
+		Reduce,
+		Accept,
+		ReuseNode,       // A subtree from the old tree was reused during an incremental parse
+		BreakdownNode,   // A subtree from the old tree couldn't be reused and was broken into its children
+		DetectError,
+		Recover,         // The parser recovered from an error (skipped or discarded tokens, ...)
+		MissingToken,    // The parser recovered from an error by inserting a missing token
+		Done,
+	};
+
+	namespace detail {
+		// Cheap classification by prefix, so counting an event never needs more than a few comparisons
+		inline ParseEvent classify_parse_event(TSLogType type, const std::string_view message) {
+			auto starts = [&](const std::string_view prefix) { return message.starts_with(prefix); };
+			if(type == TSLogTypeLex) {
+				if(starts("consume")) return ParseEvent::ConsumeCharacter;
+				if(starts("skip")) return ParseEvent::SkipCharacter;
+				return ParseEvent::Other;
+			}
+
+			switch(message.empty() ? 0 : message[0]) {
+			case 'p': return starts("process ") ? ParseEvent::Process : ParseEvent::Other;
+			case 's':
+				if(starts("shift")) return ParseEvent::Shift;
+				if(starts("skip_")) return ParseEvent::Recover;
+				return ParseEvent::Other;
+			case 'r':
+				if(starts("reduce")) return ParseEvent::Reduce;
+				if(starts("reuse_node")) return ParseEvent::ReuseNode;
+				if(starts("recover_with_missing")) return ParseEvent::MissingToken;
+				if(starts("recover")) return ParseEvent::Recover;
+				return ParseEvent::Other;
+			case 'l':
+				if(starts("lexed_lookahead")) return ParseEvent::LexedLookahead;
+				if(starts("lex_")) return ParseEvent::Lex;
+				return ParseEvent::Other;
+			case 'a': return starts("accept") ? ParseEvent::Accept : ParseEvent::Other;
+			case 'b': return starts("breakdown") ? ParseEvent::BreakdownNode : ParseEvent::Other;
+			case 'c': return starts("cant_reuse") ? ParseEvent::BreakdownNode : ParseEvent::Other;
+			case 'd':
+				if(starts("detect_error")) return ParseEvent::DetectError;
+				if(starts("done")) return ParseEvent::Done;
+				return ParseEvent::Other;
+			default: return ParseEvent::Other;
+			}
+		}
+
+		// Reads the number following `key` in a log message, ex. "version_count:" in a process message
+		inline uint32_t log_message_value(const std::string_view message, const std::string_view key) {
+			size_t at = message.find(key);
+			uint32_t value = 0;
+			if(at != std::string_view::npos)
+				std::from_chars(message.data() + at + key.size(), message.data() + message.size(), value);
+			return value;
+		}
+	}
+
+	/**
+	 * Summary of a single parse, passed to an instrumentation policy's `on_parse`.
+	 */
+	struct ParseSummary {
+		uint64_t bytes = 0;       // Size of the parsed document
+		uint64_t nanoseconds = 0; // Wall time spent in the parse
+		uint32_t node_count = 0;  // Only counted while the policy's `count_nodes` is set
+		bool incremental = false; // An old tree was passed in
+		bool completed = false;   // A tree was returned (not halted by a timeout or cancellation)
+	};
+
+	/**
+	 * Instrumentation policy which does nothing. An `InstrumentedParser` using
+	 * it compiles down to a plain `Parser`.
+	 */
+	struct NoInstrumentation {
+		static constexpr bool enabled = false;
+	};
+
+	/**
+	 * Instrumentation policy which keeps running counters of every parse.
+	 *
+	 * Policies are duck typed: `enabled` turns instrumentation on, `on_parse`
+	 * is called after every parse, and `on_event` (if present) installs a logger
+	 * while `observe_events` is set and is called for every message tree-sitter
+	 * logs. While `count_nodes` is set each finished tree is walked to count its
+	 * nodes. Custom policies can derive from this one to add callbacks on top
+	 * of the counters.
+	 *
+	 * By default only the per-parse totals (parses, bytes and time) are kept,
+	 * which costs a clock read per parse. Both of the optional counters are
+	 * opt-in since they cost more than the parse: installing a logger makes
+	 * tree-sitter format a message for every step of the parse, and counting
+	 * nodes walks the whole tree.
+	 *
+	 *   ts::InstrumentedParser parser(ts::cpp::language(), ts::ParseMetrics{.count_nodes = true});
+	 */
+	struct ParseMetrics {
+		static constexpr bool enabled = true;
+		bool count_nodes = false;
+		bool observe_events = false;
+
+		uint64_t parses = 0, incremental_parses = 0, incomplete_parses = 0;
+		uint64_t bytes_parsed = 0;
+		uint64_t nanoseconds = 0;
+
+		// Only counted while `count_nodes` is set. These are the sizes of the
+		// finished trees, the largest being the biggest tree returned so far
+		uint32_t last_node_count = 0, largest_node_count = 0;
+
+		// Only counted while `observe_events` is set
+		uint64_t lexes = 0, tokens = 0, characters_consumed = 0, characters_skipped = 0;
+		uint64_t shifts = 0, reductions = 0;
+		uint64_t reused_subtrees = 0, broken_down_subtrees = 0;
+		uint64_t errors_detected = 0, recoveries = 0, missing_tokens = 0;
+		uint32_t peak_stack_versions = 0;
+
+		/**
+		 * Get the number of subtrees built during parsing (as opposed to reused from an old tree).
+		 */
+		inline uint64_t new_subtrees() const { return shifts + reductions; }
+
+		/**
+		 * Get the average parse throughput in bytes per second.
+		 */
+		inline double bytes_per_second() const { return nanoseconds ? bytes_parsed * 1e9 / nanoseconds : 0; }
+
+		inline void reset() { *this = ParseMetrics{.count_nodes = count_nodes, .observe_events = observe_events}; }
+
+		void on_parse(const ParseSummary& summary) {
+			parses++;
+			incremental_parses += summary.incremental;
+			incomplete_parses += !summary.completed;
+			bytes_parsed += summary.bytes;
+			nanoseconds += summary.nanoseconds;
+			last_node_count = summary.node_count;
+			largest_node_count = std::max(largest_node_count, summary.node_count);
+		}
+
+		void on_event(ParseEvent event, TSLogType, const std::string_view message) {
+			switch(event) {
+			case ParseEvent::Lex: lexes++; break;
+			case ParseEvent::LexedLookahead: tokens++; break;
+			case ParseEvent::ConsumeCharacter: characters_consumed++; break;
+			case ParseEvent::SkipCharacter: characters_skipped++; break;
+			case ParseEvent::Process: peak_stack_versions = std::max(peak_stack_versions, detail::log_message_value(message, "version_count:")); break;
+			case ParseEvent::Shift: shifts++; break;
+			case ParseEvent::Reduce: reductions++; break;
+			case ParseEvent::ReuseNode: reused_subtrees++; break;
+			case ParseEvent::BreakdownNode: broken_down_subtrees++; break;
+			case ParseEvent::DetectError: errors_detected++; break;
+			case ParseEvent::MissingToken: missing_tokens++; [[fallthrough]];
+			case ParseEvent::Recover: recoveries++; break;
+			default: break;
+			}
+		}
+	};
+
+	/**
+	 * A `Parser` which reports every parse to an instrumentation policy (see
+	 * `ParseMetrics`). All of the parse functions are wrapped; when the policy
+	 * isn't `enabled` they forward straight to the `Parser` versions.
+	 */
+	template<typename Policy = ParseMetrics>
+	struct InstrumentedParser : Parser {
+		Policy policy;
+
+		using Parser::Parser;
+		InstrumentedParser(const TSLanguage* language, Policy policy) : Parser(language), policy(std::move(policy)) { }
+
+		template<typename... Args>
+		inline auto parse(Args&&... args) { return instrument(first_tree(args...), [&] { return Parser::parse(std::forward<Args>(args)...); }); }
+		template<typename... Args>
+		inline auto parse_chunks(Args&&... args) { return instrument(first_tree(args...), [&] { return Parser::parse_chunks(std::forward<Args>(args)...); }); }
+		template<typename... Args>
+		inline auto parse_string(Args&&... args) { return instrument(first_tree(args...), [&] { return Parser::parse_string(std::forward<Args>(args)...); }); }
+		template<typename... Args>
+		inline auto parse_string_encoding(Args&&... args) { return instrument(first_tree(args...), [&] { return Parser::parse_string_encoding(std::forward<Args>(args)...); }); }
+		template<typename... Args>
+		inline auto parse_source(Args&&... args) { return instrument(first_tree(args...), [&] { return Parser::parse_source(std::forward<Args>(args)...); }); }
+		template<typename... Args>
+		inline auto parse_file(Args&&... args) { return instrument(first_tree(args...), [&] { return Parser::parse_file(std::forward<Args>(args)...); }); }
+
+		// Finds the old tree (if any) among a parse function's arguments
+		template<typename First, typename... Rest>
+		static bool first_tree(const First& first, const Rest&...) {
+			if constexpr(std::is_convertible_v<const First&, const TSTree*> && !std::is_convertible_v<const First&, std::string_view>) return (const TSTree*)first != nullptr;
+			else return false;
+		}
+		static bool first_tree() { return false; }
+
+		static void log(void* payload, TSLogType type, const char* message) {
+			const std::string_view text = message;
+			((Policy*)payload)->on_event(detail::classify_parse_event(type, text), type, text);
+		}
+
+		template<typename Parse>
+		auto instrument(bool incremental, Parse&& parse) {
+			if constexpr(!Policy::enabled) return parse();
+			else {
+				TSLogger previous = logger();
+				if constexpr(requires(Policy& p, std::string_view m) { p.on_event(ParseEvent::Other, TSLogTypeParse, m); }) {
+					bool observe = true;
+					if constexpr(requires { policy.observe_events; }) observe = policy.observe_events;
+					// The logger is installed per parse since the policy's address changes if the parser moves
+					if(observe) set_logger({&policy, log});
+				}
+
+				auto start = std::chrono::steady_clock::now();
+				auto tree = parse();
+				auto elapsed = std::chrono::steady_clock::now() - start;
+				set_logger(previous);
+
+				ParseSummary summary;
+				summary.nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+				summary.incremental = incremental;
+				summary.completed = (bool)tree;
+				if(tree) {
+					Node root = tree.root_node();
+					summary.bytes = root.end_byte();
+					bool count = false;
+					if constexpr(requires { policy.count_nodes; }) count = policy.count_nodes;
+					if(count) {
+						TreeCursor cursor(root);
+						while(true) {
+							summary.node_count++;
+							if(cursor.goto_first_child()) continue;
+							bool finished = false;
+							while(!finished && !cursor.goto_next_sibling())
+								finished = !cursor.goto_parent();
+							if(finished) break;
+						}
+					}
+				}
+				policy.on_parse(summary);
+				return tree;
+			}
+		}
+	};
+}
+
+#endif // __TREE_SITTERPP_INSTRUMENTATION_HPP__
\ No newline at end of file
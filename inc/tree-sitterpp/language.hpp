@@ -2,21 +2,21 @@
 #define __TREE_SITTERPP_LANGUAGE_HPP__
 
 #include "helpers.hpp"
-#include "tree_sitter/parser.h"
 
 namespace TreeSitter {
 
-	struct Language : TSLanguage {
+	// Non-owning handle to a language, languages are statically allocated by their grammar so copying one is a pointer copy
+	struct Language {
+		const TSLanguage* handle = nullptr;
+
 		Language() = default;
-		Language(TSLanguage* lang) : TSLanguage(*lang) { }
+		Language(const TSLanguage* lang) : handle(lang) { }
 		Language(const Language&) = default;
-		Language(Language&&) = default;
-		Language& operator=(TSLanguage* lang) { *this = Language(lang); return *this; }
+		Language& operator=(const TSLanguage* lang) { handle = lang; return *this; }
 		Language& operator=(const Language&) = default;
-		Language& operator=(Language&&) = default;
 
-		inline operator TSLanguage*() { return this; }
-		inline operator const TSLanguage*() const { return this; }
+		inline operator const TSLanguage*() const { return handle; }
+		inline bool operator==(const Language& other) const { return handle == other.handle; }
 
 		/**
 		 * Get the number of distinct node types in the language.
@@ -31,22 +31,22 @@ namespace TreeSitter {
 		/**
 		 * Get the numerical id for the given node type string.
 		 */
-		inline TSSymbol symbol_for_name(const std::string_view name, bool is_named = true) { return ts_language_symbol_for_name(*this, name.data(), name.size(), is_named); }
+		inline TSSymbol symbol_for_name(const std::string_view name, bool is_named = true) const { return ts_language_symbol_for_name(*this, name.data(), name.size(), is_named); }
 
 		/**
 		 * Get the number of distinct field names in the language.
 		 */
-		inline uint32_t field_count() { return ts_language_field_count(*this); }
+		inline uint32_t field_count() const { return ts_language_field_count(*this); }
 
 		/**
 		 * Get the field name string for the given numerical id.
 		 */
-		inline const std::string_view field_name_for_id(TSFieldId id) { return ts_language_field_name_for_id(*this, id); }
+		inline const std::string_view field_name_for_id(TSFieldId id) const { return ts_language_field_name_for_id(*this, id); }
 
 		/**
 		 * Get the numerical id for the given field name string.
 		 */
-		inline TSFieldId field_id_for_name(const std::string_view name) { return ts_language_field_id_for_name(*this, name.data(), name.size()); }
+		inline TSFieldId field_id_for_name(const std::string_view name) const { return ts_language_field_id_for_name(*this, name.data(), name.size()); }
 
 		/**
 		 * Check whether the given node type id belongs to named nodes, anonymous nodes,
@@ -54,7 +54,7 @@ namespace TreeSitter {
 		 *
 		 * See also `ts_node_is_named`. Hidden nodes are never returned from the API.
 		 */
-		inline TSSymbolType symbol_type(TSSymbol symbol) { return ts_language_symbol_type(*this, symbol); }
+		inline TSSymbolType symbol_type(TSSymbol symbol) const { return ts_language_symbol_type(*this, symbol); }
 
 		/**
 		 * Get the ABI version number for this language. This version number is used
@@ -63,7 +63,7 @@ namespace TreeSitter {
 		 *
 		 * See also `ts_parser_set_language`.
 		 */
-		inline uint32_t version() { return ts_language_version(*this); }
+		inline uint32_t version() const { return ts_language_version(*this); }
 	};
 
 }
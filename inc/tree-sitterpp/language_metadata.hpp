@@ -0,0 +1,107 @@
+#ifndef __TREE_SITTERPP_LANGUAGE_METADATA_HPP__
+#define __TREE_SITTERPP_LANGUAGE_METADATA_HPP__
+
+#include "helpers.hpp"
+#include <iterator>
+#include <span>
+#include <string_view>
+
+namespace TreeSitter {
+
+	// Compile time copy of a symbol's entry in the language's symbol tables
+	struct SymbolMetadata {
+		std::string_view name;
+		bool visible;
+		bool named;
+		bool supertype;
+	};
+
+	// A supertype symbol together with the symbols which can appear in its place
+	struct SupertypeMetadata {
+		TSSymbol symbol;
+		std::span<const TSSymbol> subtypes;
+	};
+
+	/**
+	 * Constant expression queries over a language's symbol and field tables,
+	 * generated from the grammar by `tools/generate_language_metadata.cpp`
+	 * (see `languages/cpp.hpp`). These mirror the `Language` functions but
+	 * fold to constants when their arguments are known at compile time.
+	 */
+	template<const auto& symbols, const auto& fields, const auto& supertypes>
+	struct LanguageMetadata {
+		static constexpr TSSymbol error_symbol = (TSSymbol)-1;
+		static constexpr TSSymbol error_repeat_symbol = (TSSymbol)-2;
+
+		/**
+		 * Get the number of distinct node types and field names in the language.
+		 */
+		static constexpr uint32_t symbol_count() { return std::size(symbols); }
+		static constexpr uint32_t field_count() { return std::size(fields) - 1; }
+
+		/**
+		 * Get the metadata for the given symbol, the error symbols aren't part of
+		 * the tables and are handled specially.
+		 */
+		static constexpr SymbolMetadata symbol(TSSymbol symbol) {
+			if(symbol < std::size(symbols)) return symbols[symbol];
+			if(symbol == error_symbol) return {"ERROR", true, true, false};
+			if(symbol == error_repeat_symbol) return {"_ERROR", false, false, false};
+			return {"", false, false, false};
+		}
+
+		static constexpr std::string_view symbol_name(TSSymbol s) { return symbol(s).name; }
+		static constexpr bool is_named(TSSymbol s) { return symbol(s).named; }
+		static constexpr bool is_visible(TSSymbol s) { return symbol(s).visible; }
+		static constexpr bool is_supertype(TSSymbol s) { return symbol(s).supertype; }
+
+		/**
+		 * Get the numerical id for the given node type string, or 0 if there is
+		 * no such symbol. Like `ts_language_symbol_for_name`, only visible symbols
+		 * are considered.
+		 */
+		static constexpr TSSymbol symbol_for_name(const std::string_view name, bool named) {
+			for(TSSymbol i = 0; i < std::size(symbols); i++)
+				if(symbols[i].visible && symbols[i].named == named && symbols[i].name == name)
+					return i;
+			return 0;
+		}
+
+		/**
+		 * Get the field name string for the given numerical id, or an empty string.
+		 */
+		static constexpr std::string_view field_name(TSFieldId id) { return id < std::size(fields) ? fields[id] : std::string_view{}; }
+
+		/**
+		 * Get the numerical id for the given field name, or 0 if there is no such
+		 * field. `field_id("declarator")` in a constant expression compiles to a
+		 * constant.
+		 */
+		static constexpr TSFieldId field_id(const std::string_view name) {
+			for(TSFieldId i = 1; i < std::size(fields); i++)
+				if(fields[i] == name) return i;
+			return 0;
+		}
+
+		/**
+		 * Get the symbols which can appear in place of the given supertype (empty
+		 * if the symbol isn't a supertype).
+		 */
+		static constexpr std::span<const TSSymbol> subtypes(TSSymbol supertype) {
+			for(auto& entry: supertypes)
+				if(entry.symbol == supertype) return entry.subtypes;
+			return {};
+		}
+
+		/**
+		 * Check if `symbol` can appear in place of the given supertype.
+		 */
+		static constexpr bool is_subtype(TSSymbol supertype, TSSymbol symbol) {
+			for(TSSymbol subtype: subtypes(supertype))
+				if(subtype == symbol) return true;
+			return false;
+		}
+	};
+}
+
+#endif // __TREE_SITTERPP_LANGUAGE_METADATA_HPP__
\ No newline at end of file
@@ -0,0 +1,260 @@
+#ifndef __TREE_SITTERPP_LANGUAGE_REGISTRY_HPP__
+#define __TREE_SITTERPP_LANGUAGE_REGISTRY_HPP__
+
+#include "language.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <filesystem>
+#include <initializer_list>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#if __has_include(<dlfcn.h>)
+	#include <dlfcn.h>
+	#define TREE_SITTERPP_HAS_DLOPEN
+#endif
+
+namespace TreeSitter {
+
+	/**
+	 * Resolves languages by name or file extension.
+	 *
+	 * Languages are either registered with a statically linked `Language`, or
+	 * loaded on first use from a shared library grammar (where `dlopen` is
+	 * available). Libraries are looked for in each search path as
+	 * `libtree-sitter-<name>`, `tree-sitter-<name>`, `lib<name>` and `<name>`
+	 * (with the platform's shared library suffix), and must export
+	 * `tree_sitter_<name>` (dashes replaced with underscores) unless another
+	 * symbol was registered. Loaded languages whose ABI version this build of
+	 * tree-sitter can't parse are rejected, see `error`.
+	 *
+	 *   ts::LanguageRegistry& languages = ts::LanguageRegistry::global();
+	 *   languages.add("cpp", ts::cpp::language(), {".cpp", ".hpp", ".h"});
+	 *   languages.add_extensions("rust", {".rs"});
+	 *   ts::Language rust = languages.for_path("src/main.rs"); // Loads libtree-sitter-rust.so
+	 *
+	 * Lookups are thread safe. Libraries stay loaded for the registry's lifetime,
+	 * so trees and parsers using its languages must not outlive it.
+	 */
+	struct LanguageRegistry {
+		struct Entry {
+			Language language;
+			std::filesystem::path library; // Empty to search for the library
+			std::string symbol;            // Empty for tree_sitter_<name>
+			void* handle = nullptr;        // Library handle, if the language was loaded
+			bool attempted = false;        // Loading has been tried (whether or not it worked)
+			std::string error;
+		};
+
+		mutable std::mutex mutex;
+		std::vector<std::filesystem::path> search_paths;
+		std::unordered_map<std::string, Entry> entries;
+		std::unordered_map<std::string, std::string> extensions; // Extension (including the dot) -> language name
+
+		LanguageRegistry() = default;
+		LanguageRegistry(const LanguageRegistry&) = delete;
+		LanguageRegistry& operator=(const LanguageRegistry&) = delete;
+		~LanguageRegistry() {
+#ifdef TREE_SITTERPP_HAS_DLOPEN
+			for(auto& [name, entry]: entries)
+				if(entry.handle) dlclose(entry.handle);
+#endif
+		}
+
+		/**
+		 * Get the process wide registry. Its search path starts with the
+		 * directories listed in the `TREE_SITTERPP_LANGUAGE_PATH` environment
+		 * variable. It is never destroyed, so its languages stay valid until exit.
+		 */
+		static LanguageRegistry& global() {
+			static LanguageRegistry* registry = [] {
+				auto* registry = new LanguageRegistry;
+				if(const char* path = std::getenv("TREE_SITTERPP_LANGUAGE_PATH"))
+					registry->add_search_paths(path);
+				return registry;
+			}();
+			return *registry;
+		}
+
+		/**
+		 * Add a directory to search for shared library grammars in. Languages which
+		 * previously couldn't be found are searched for again on their next use.
+		 */
+		void add_search_path(const std::filesystem::path& directory) {
+			std::scoped_lock lock(mutex);
+			search_paths.push_back(directory);
+			for(auto& [name, entry]: entries)
+				if(!entry.language) entry.attempted = false;
+		}
+
+		/**
+		 * Add each directory in a list separated like `PATH` (`:`, or `;` on Windows).
+		 */
+		void add_search_paths(const std::string_view list) {
+#ifdef _WIN32
+			constexpr char separator = ';';
+#else
+			constexpr char separator = ':';
+#endif
+			for(size_t start = 0; start <= list.size();) {
+				size_t end = std::min(list.find(separator, start), list.size());
+				if(end > start) add_search_path(list.substr(start, end - start));
+				start = end + 1;
+			}
+		}
+
+		/**
+		 * Register a statically linked language, and optionally the file extensions it handles.
+		 */
+		void add(const std::string_view name, Language language, std::initializer_list<std::string_view> file_extensions = {}) {
+			std::scoped_lock lock(mutex);
+			Entry& entry = entries[std::string(name)];
+			entry.language = language;
+			entry.attempted = true;
+			entry.error.clear();
+			add_extensions_locked(name, file_extensions);
+		}
+
+		/**
+		 * Register a language to be loaded from the given shared library the
+		 * first time it is used, and optionally the file extensions it handles.
+		 */
+		void add_library(const std::string_view name, const std::filesystem::path& library, std::initializer_list<std::string_view> file_extensions = {}, const std::string_view symbol = {}) {
+			std::scoped_lock lock(mutex);
+			Entry& entry = entries[std::string(name)];
+			if(entry.handle || entry.language) return; // Already resolved
+			entry.library = library;
+			entry.symbol = symbol;
+			entry.attempted = false;
+			add_extensions_locked(name, file_extensions);
+		}
+
+		/**
+		 * Associate file extensions (ex. ".rs") with a language name. The language
+		 * doesn't need to be registered, it is searched for when first used.
+		 */
+		void add_extensions(const std::string_view name, std::initializer_list<std::string_view> file_extensions) {
+			std::scoped_lock lock(mutex);
+			add_extensions_locked(name, file_extensions);
+		}
+
+		/**
+		 * Get the language with the given name, loading it if needed. Returns a null
+		 * language if it couldn't be found or loaded.
+		 */
+		Language get(const std::string_view name) {
+			std::scoped_lock lock(mutex);
+			return resolve(name);
+		}
+		inline Language operator[](const std::string_view name) { return get(name); }
+
+		/**
+		 * Get the language associated with the given file extension (including the
+		 * dot), or with the extension of the given path.
+		 */
+		Language for_extension(const std::string_view extension) {
+			std::scoped_lock lock(mutex);
+			auto found = extensions.find(std::string(extension));
+			if(found == extensions.end()) return {};
+			return resolve(found->second);
+		}
+		inline Language for_path(const std::filesystem::path& path) { return for_extension(path.extension().string()); }
+
+		/**
+		 * Check if a language with the given name has been loaded (or statically registered).
+		 */
+		bool loaded(const std::string_view name) const {
+			std::scoped_lock lock(mutex);
+			auto found = entries.find(std::string(name));
+			return found != entries.end() && found->second.language;
+		}
+
+		/**
+		 * Get why the language with the given name couldn't be loaded, or nothing
+		 * if it hasn't failed.
+		 */
+		std::optional<std::string> error(const std::string_view name) const {
+			std::scoped_lock lock(mutex);
+			auto found = entries.find(std::string(name));
+			if(found == entries.end() || found->second.error.empty()) return {};
+			return found->second.error;
+		}
+
+		// Must be called with the mutex held
+		void add_extensions_locked(const std::string_view name, std::initializer_list<std::string_view> file_extensions) {
+			for(auto extension: file_extensions)
+				extensions[std::string(extension)] = name;
+		}
+
+		// Must be called with the mutex held
+		Language resolve(const std::string_view name) {
+			Entry& entry = entries[std::string(name)];
+			if(entry.attempted) return entry.language;
+			entry.attempted = true;
+			load(name, entry);
+			return entry.language;
+		}
+
+		void load(const std::string_view name, Entry& entry) {
+#ifdef TREE_SITTERPP_HAS_DLOPEN
+	#if defined(__APPLE__)
+			constexpr std::string_view suffix = ".dylib";
+	#else
+			constexpr std::string_view suffix = ".so";
+	#endif
+			std::string symbol = entry.symbol;
+			if(symbol.empty()) {
+				symbol = "tree_sitter_" + std::string(name);
+				std::replace(symbol.begin(), symbol.end(), '-', '_');
+			}
+
+			std::vector<std::filesystem::path> candidates;
+			if(!entry.library.empty()) candidates.push_back(entry.library);
+			else for(auto& directory: search_paths)
+				for(std::string_view prefix: {"libtree-sitter-", "tree-sitter-", "lib", ""})
+					candidates.push_back(directory / (std::string(prefix) + std::string(name) + std::string(suffix)));
+
+			for(auto& candidate: candidates) {
+				if(entry.library.empty() && !std::filesystem::exists(candidate)) continue;
+				void* handle = dlopen(candidate.c_str(), RTLD_NOW | RTLD_LOCAL);
+				if(!handle) {
+					const char* message = dlerror();
+					entry.error = message ? message : "couldn't load " + candidate.string();
+					continue;
+				}
+
+				auto function = (const TSLanguage* (*)())dlsym(handle, symbol.c_str());
+				const TSLanguage* language = function ? function() : nullptr;
+				if(!language) {
+					entry.error = candidate.string() + " doesn't export " + symbol;
+					dlclose(handle);
+					continue;
+				}
+
+				uint32_t version = Language(language).version();
+				if(version < TREE_SITTER_MIN_COMPATIBLE_LANGUAGE_VERSION || version > TREE_SITTER_LANGUAGE_VERSION) {
+					entry.error = candidate.string() + " has ABI version " + std::to_string(version) + ", expected "
+						+ std::to_string(TREE_SITTER_MIN_COMPATIBLE_LANGUAGE_VERSION) + " to " + std::to_string(TREE_SITTER_LANGUAGE_VERSION);
+					dlclose(handle);
+					continue;
+				}
+
+				entry.handle = handle;
+				entry.library = candidate;
+				entry.language = language;
+				entry.error.clear();
+				return;
+			}
+			if(entry.error.empty()) entry.error = "no library found for " + std::string(name);
+#else
+			entry.error = "runtime language loading isn't supported on this platform";
+#endif
+		}
+	};
+}
+
+#endif // __TREE_SITTERPP_LANGUAGE_REGISTRY_HPP__
\ No newline at end of file
@@ -7,22 +7,26 @@ namespace TreeSitter::cpp {
 	namespace detail { extern "C" {
 		// Declare the `tree_sitter_cpp` function, which is
 		// implemented by the `tree-sitter-cpp` library.
-		extern TSLanguage* tree_sitter_cpp();
+		extern const TSLanguage* tree_sitter_cpp();
 	} }
 
-	// Returns a static reference to the C++ language
-	inline Language& language() {
-		static Language cpp;
-		static bool first = true;
-
-		if(first){
-			first = false;
-			cpp = detail::tree_sitter_cpp();
-		}
-
-		return cpp;
-	}
+	// Returns a handle to the C++ language, the language is statically allocated so this is safe to call from any thread
+	inline Language language() { return detail::tree_sitter_cpp(); }
+}
 
+// Prefer the tables generated from the grammar at build time (see CMakeLists.txt). Only
+// they provide the `ts::cpp::fields` enum and the constexpr `ts::cpp::metadata`, so code
+// using those only compiles when the parser submodule (parser/src/parser.c) is checked
+// out; `ts::cpp::Symbols` has the same names either way
+#if __has_include(<tree-sitterpp/languages/cpp_metadata.hpp>)
+#include <tree-sitterpp/languages/cpp_metadata.hpp>
+namespace TreeSitter::cpp {
+	// Fields live in their own namespace, since the grammar reuses names between fields and symbols
+	static_assert(fields::initializer > 0 && fields::declarator > 0 && Symbols::field_initializer > 0,
+		"ts::cpp::fields doesn't match the grammar's field names");
+}
+#else
+namespace TreeSitter::cpp {
 	// Enum with all of the symbols in the language
 	enum Symbols : TSSymbol {
 		identifier = 1,
@@ -450,5 +454,13 @@ namespace TreeSitter::cpp {
 		alias_type_identifier = 423,
 	};
 }
+#endif
+
+namespace TreeSitter::cpp {
+	// Both branches must spell the symbols the same way, keywords have a trailing underscore
+	static_assert(Symbols::identifier == 1 && Symbols::true_ > 0 && Symbols::false_ > 0 && Symbols::auto_ > 0 && Symbols::this_ > 0
+		&& Symbols::nullptr_ > 0 && Symbols::decltype_ > 0 && Symbols::noexcept_ > 0 && Symbols::field_initializer > 0
+		&& Symbols::field_declaration > 0, "ts::cpp::Symbols doesn't match the fallback enum's names");
+}
 
 #endif // __TREE_SITTERPP_LANGUAGES_CPP_HPP__
\ No newline at end of file
@@ -0,0 +1,125 @@
+#ifndef __TREE_SITTERPP_MAPPED_FILE_HPP__
+#define __TREE_SITTERPP_MAPPED_FILE_HPP__
+
+#include "helpers.hpp"
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <string_view>
+
+#if __has_include(<sys/mman.h>)
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+	#define TREE_SITTERPP_HAS_MMAP
+#endif
+
+namespace TreeSitter {
+
+	/**
+	 * Read only view of a file's contents.
+	 *
+	 * Where available the file is memory mapped, so its pages are only read in
+	 * as they are touched and are shared with the OS page cache instead of being
+	 * copied into the process. Elsewhere the file is read into a string.
+	 */
+	struct MappedFile {
+		const char* data = nullptr;
+		size_t length = 0;
+		bool mapped = false;
+		bool valid = false;
+		std::string fallback;
+
+		MappedFile() = default;
+		explicit MappedFile(const std::filesystem::path& path) { open(path); }
+		MappedFile(const MappedFile&) = delete;
+		MappedFile(MappedFile&& move) { *this = std::move(move); }
+		~MappedFile() { close(); }
+		MappedFile& operator=(const MappedFile&) = delete;
+		MappedFile& operator=(MappedFile&& move) {
+			if(this == &move) return *this;
+			close();
+			std::swap(data, move.data);
+			std::swap(length, move.length);
+			std::swap(mapped, move.mapped);
+			std::swap(valid, move.valid);
+			std::swap(fallback, move.fallback);
+			if(!mapped) data = fallback.data();
+			return *this;
+		}
+
+		/**
+		 * Check if the file was opened successfully.
+		 */
+		inline explicit operator bool() const { return valid; }
+		inline bool is_open() const { return valid; }
+
+		/**
+		 * Get the contents of the file.
+		 */
+		inline std::string_view view() const { return {data, length}; }
+		inline operator std::string_view() const { return view(); }
+		inline size_t size() const { return length; }
+
+		/**
+		 * Open the given file, closing the current file first.
+		 *
+		 * Returns false if the file couldn't be opened or is too large for
+		 * tree-sitter to parse (more than 4GB).
+		 */
+		bool open(const std::filesystem::path& path) {
+			close();
+#ifdef TREE_SITTERPP_HAS_MMAP
+			int fd = ::open(path.c_str(), O_RDONLY);
+			if(fd < 0) return false;
+
+			struct stat info;
+			if(fstat(fd, &info) != 0 || (uint64_t)info.st_size > UINT32_MAX) {
+				::close(fd);
+				return false;
+			}
+
+			length = info.st_size;
+			if(length > 0) {
+				void* map = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+				if(map == MAP_FAILED) {
+					::close(fd);
+					length = 0;
+					return false;
+				}
+				// Parsing reads front to back, so start reading ahead straight away
+				madvise(map, length, MADV_WILLNEED);
+				madvise(map, length, MADV_SEQUENTIAL);
+				data = (const char*)map;
+				mapped = true;
+			}
+			::close(fd); // The mapping keeps its own reference to the file
+#else
+			std::ifstream file(path, std::ios::binary | std::ios::ate);
+			if(!file || (uint64_t)file.tellg() > UINT32_MAX) return false;
+			fallback.resize(file.tellg());
+			file.seekg(0);
+			if(!file.read(fallback.data(), fallback.size())) return false;
+			length = fallback.size();
+#endif
+			if(!mapped) data = fallback.data();
+			return valid = true;
+		}
+
+		/**
+		 * Unmap (or release) the file.
+		 */
+		void close() {
+#ifdef TREE_SITTERPP_HAS_MMAP
+			if(mapped) munmap((void*)data, length);
+#endif
+			fallback.clear();
+			data = nullptr;
+			length = 0;
+			mapped = valid = false;
+		}
+	};
+}
+
+#endif // __TREE_SITTERPP_MAPPED_FILE_HPP__
\ No newline at end of file
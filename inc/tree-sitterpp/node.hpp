@@ -5,6 +5,16 @@
 #include <optional>
 
 namespace TreeSitter {
+	struct TreeCursor;
+
+	// Orders in which the nodes below a node can be walked (see traversal.hpp)
+	enum class Traversal { Children, NamedChildren, Preorder, Postorder };
+	namespace detail { template<Traversal order, typename Cursor = TreeCursor> struct CursorRange; }
+	using ChildRange = detail::CursorRange<Traversal::Children>;
+	using NamedChildRange = detail::CursorRange<Traversal::NamedChildren>;
+	using PreorderRange = detail::CursorRange<Traversal::Preorder>;
+	using PostorderRange = detail::CursorRange<Traversal::Postorder>;
+
 	struct Node : TSNode {
 		Node() { id = nullptr; tree = nullptr; }
 		inline Node(const TSNode& copy) { *this = copy; };
@@ -71,6 +81,15 @@ namespace TreeSitter {
 		inline std::pair<TSPoint, TSPoint> point_range() const { return { start_point(), end_point() }; }
 		inline std::pair<TSPoint, TSPoint> get_point_range() const { return point_range(); }
 
+		/**
+		 * Get the source code covered by the node out of the source the node's tree
+		 * was parsed from, without copying.
+		 *
+		 * See also `SourceTree::text`, which remembers the source for you.
+		 */
+		inline std::string_view text(const std::string_view source) const { return source.substr(start_byte(), end_byte() - start_byte()); }
+		inline std::string_view get_text(const std::string_view source) const { return text(source); }
+
 		/**
 		 * Get an S-expression representing the node as a string.
 		 *
@@ -80,32 +99,67 @@ namespace TreeSitter {
 		std::string string() const {
 			char* raw = ts_node_string(*this);
 			std::string out = raw;
-			free(raw);
+			detail::free_ts_memory(raw);
 			return out;
 		}
 		inline std::string get_string() const { return string(); }
 
 		/**
 		 * Gets the index of this child in its parent
+		 *
+		 * Nodes don't store their position, so this is O(depth + siblings): finding
+		 * the parent walks down from the root, then the parent's children are
+		 * scanned once. When visiting many nodes use a `TreeCursor` instead, its
+		 * `current_child_index` and `current_field_id` are constant time.
 		 */
-		uint32_t child_index() const {
-			uint32_t i = 0;
-
-			Node prev = *this;
-			while(prev.has_prev_sibling()){
-				i++;
-				prev = prev_sibling();
-			}
-
-			return i;
-		}
+		inline uint32_t child_index() const { return position_in_parent().child_index; }
 		inline uint32_t get_child_index() const { return child_index(); }
 
 		/**
-		 * Gets the field name of this node
+		 * Gets the field name of this node, O(depth + siblings) like `child_index`
 		 */
-		std::optional<std::string_view> field_name() { return get_parent().get_field_name_for_child(child_index()); }
-		inline std::optional<std::string_view> get_field_name() { return field_name(); }
+		std::optional<std::string_view> field_name() const {
+			auto name = position_in_parent().field_name;
+			if(name == nullptr) return {};
+			return name;
+		}
+		inline std::optional<std::string_view> get_field_name() const { return field_name(); }
+
+		/**
+		 * Gets the field id of this node, zero if the node isn't in a field.
+		 * O(depth + siblings) like `child_index`.
+		 */
+		inline TSFieldId field_id() const { return position_in_parent().field_id; }
+		inline TSFieldId get_field_id() const { return field_id(); }
+
+		/**
+		 * Gets the index, field id, and field name of this node in its parent with
+		 * a single cursor pass over the parent's children. Finding the parent is
+		 * itself O(depth), see `child_index`.
+		 */
+		struct ParentPosition {
+			uint32_t child_index = 0;
+			TSFieldId field_id = 0;
+			const char* field_name = nullptr;
+		};
+		ParentPosition position_in_parent() const {
+			ParentPosition out;
+			TSNode parent = ts_node_parent(*this);
+			if(ts_node_is_null(parent)) return out;
+
+			TSTreeCursor cursor = ts_tree_cursor_new(parent);
+			if(ts_tree_cursor_goto_first_child(&cursor))
+				do {
+					if(ts_node_eq(ts_tree_cursor_current_node(&cursor), *this)) {
+						out.field_id = ts_tree_cursor_current_field_id(&cursor);
+						out.field_name = ts_tree_cursor_current_field_name(&cursor);
+						break;
+					}
+					out.child_index++;
+				} while(ts_tree_cursor_goto_next_sibling(&cursor));
+			ts_tree_cursor_delete(&cursor);
+			return out;
+		}
 
 		/**
 		 * Check if the node is null. Functions like `child` and
@@ -174,6 +228,23 @@ namespace TreeSitter {
 		inline uint32_t child_count() const { return ts_node_child_count(*this); }
 		inline uint32_t get_child_count() const { return child_count(); }
 
+		/**
+		 * Get a range over the node's children (or only its *named* children).
+		 *
+		 * Iteration walks a single tree cursor, so each step is constant time
+		 * unlike calling `child(i)` in a loop. The ranges work with `std::ranges`
+		 * algorithms and views.
+		 */
+		inline ChildRange children() const;
+		inline NamedChildRange named_children() const;
+
+		/**
+		 * Get a range over this node and all of its descendants, visiting parents
+		 * before (preorder) or after (postorder) their children.
+		 */
+		inline PreorderRange preorder() const;
+		inline PostorderRange postorder() const;
+
 		/**
 		 * Get the node's *named* child at the given index.
 		 *
@@ -281,4 +352,7 @@ namespace TreeSitter {
 	};
 }
 
+// Defines the traversal ranges declared above, which need a complete Node
+#include "traversal.hpp"
+
 #endif // __TREE_SITTERPP_NODE_HPP__
\ No newline at end of file
@@ -0,0 +1,154 @@
+#ifndef __TREE_SITTERPP_PARALLEL_PARSER_HPP__
+#define __TREE_SITTERPP_PARALLEL_PARSER_HPP__
+
+#include "parser.hpp"
+#include <algorithm>
+#include <deque>
+#include <filesystem>
+#include <mutex>
+#include <numeric>
+#include <optional>
+#include <thread>
+#include <vector>
+
+namespace TreeSitter {
+	namespace detail {
+		// Queue of job indices owned by one worker. The owner takes jobs from the
+		// front, idle workers steal from the back.
+		struct WorkQueue {
+			std::mutex mutex;
+			std::deque<size_t> jobs;
+
+			std::optional<size_t> pop() {
+				std::scoped_lock lock(mutex);
+				if(jobs.empty()) return {};
+				size_t job = jobs.front();
+				jobs.pop_front();
+				return job;
+			}
+
+			std::optional<size_t> steal() {
+				std::scoped_lock lock(mutex);
+				if(jobs.empty()) return {};
+				size_t job = jobs.back();
+				jobs.pop_back();
+				return job;
+			}
+		};
+	}
+
+	/**
+	 * Parses batches of documents across a set of worker threads.
+	 *
+	 * Every worker owns a `Parser` which is created up front with the batch's
+	 * language and reused for every document the worker parses. Jobs are handed
+	 * out largest first and idle workers steal from busy ones, so a few huge
+	 * files don't leave the other cores idle at the end of a batch.
+	 */
+	struct ParallelParser {
+		std::vector<Parser> parsers;
+
+		explicit ParallelParser(const TSLanguage* language, size_t threads = std::thread::hardware_concurrency()) {
+			parsers.reserve(std::max<size_t>(threads, 1));
+			for(size_t i = 0; i < std::max<size_t>(threads, 1); i++)
+				parsers.emplace_back(language);
+		}
+
+		/**
+		 * Get the number of worker threads (and parsers) used for each batch.
+		 */
+		inline size_t thread_count() const { return parsers.size(); }
+		inline size_t get_thread_count() const { return thread_count(); }
+
+		/**
+		 * Run `job(parser, index, worker)` for every index in [0, count) across the
+		 * worker threads. `cost(index)` estimates the relative size of each job (ex.
+		 * its length in bytes) and is used to start the largest jobs first.
+		 *
+		 * Jobs run concurrently and must not throw. `parser` is the worker's own
+		 * parser, jobs are free to change its settings (language, included ranges,
+		 * ...) but should leave it ready for the next job.
+		 */
+		template<typename Cost, typename Job>
+		void run(size_t count, Cost&& cost, Job&& job) {
+			if(count == 0) return;
+			size_t workers = std::min(count, thread_count());
+
+			std::vector<size_t> order(count);
+			std::iota(order.begin(), order.end(), 0);
+			std::vector<decltype(cost(size_t{}))> costs(count);
+			for(size_t i = 0; i < count; i++) costs[i] = cost(i);
+			std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return costs[a] > costs[b]; });
+
+			std::vector<detail::WorkQueue> queues(workers);
+			for(size_t i = 0; i < count; i++)
+				queues[i % workers].jobs.push_back(order[i]);
+
+			auto work = [&](size_t worker) {
+				while(true) {
+					auto next = queues[worker].pop();
+					for(size_t victim = 1; !next && victim < workers; victim++)
+						next = queues[(worker + victim) % workers].steal();
+					// Nothing new is ever queued, so once every queue is empty we are done
+					if(!next) return;
+					job(parsers[worker], *next, worker);
+				}
+			};
+
+			std::vector<std::jthread> threads;
+			threads.reserve(workers - 1);
+			for(size_t worker = 1; worker < workers; worker++)
+				threads.emplace_back(work, worker);
+			work(0);
+		}
+
+		/**
+		 * Parse every source, calling `callback(index, tree)` as each tree is
+		 * finished. The callback is invoked concurrently from the worker threads.
+		 */
+		template<typename Callback>
+		void parse(std::span<const std::string_view> sources, Callback&& callback) {
+			run(sources.size(), [&](size_t i) { return sources[i].size(); }, [&](Parser& parser, size_t i, size_t) {
+				callback(i, parser.parse_string(sources[i]));
+			});
+		}
+
+		/**
+		 * Parse every source, returning the trees in the same order as the sources.
+		 */
+		std::vector<Tree> parse(std::span<const std::string_view> sources) {
+			std::vector<Tree> trees(sources.size());
+			parse(sources, [&](size_t i, Tree tree) { trees[i] = std::move(tree); });
+			return trees;
+		}
+
+		/**
+		 * Map and parse every file (see `Parser::parse_file`), calling
+		 * `callback(index, tree)` as each tree is finished. Files which can't be
+		 * read produce a null tree. The callback is invoked concurrently from the
+		 * worker threads.
+		 */
+		template<typename Callback>
+		void parse_files(std::span<const std::filesystem::path> paths, Callback&& callback) {
+			auto size = [&](size_t i) {
+				std::error_code error;
+				auto size = std::filesystem::file_size(paths[i], error);
+				return error ? 0 : size;
+			};
+			run(paths.size(), size, [&](Parser& parser, size_t i, size_t) {
+				callback(i, parser.parse_file(paths[i]));
+			});
+		}
+
+		/**
+		 * Map and parse every file, returning the trees in the same order as the paths.
+		 */
+		std::vector<SourceTree> parse_files(std::span<const std::filesystem::path> paths) {
+			std::vector<SourceTree> trees(paths.size());
+			parse_files(paths, [&](size_t i, SourceTree tree) { trees[i] = std::move(tree); });
+			return trees;
+		}
+	};
+}
+
+#endif // __TREE_SITTERPP_PARALLEL_PARSER_HPP__
\ No newline at end of file
@@ -0,0 +1,185 @@
+#ifndef __TREE_SITTERPP_PARSE_CACHE_HPP__
+#define __TREE_SITTERPP_PARSE_CACHE_HPP__
+
+#include "hash.hpp"
+#include "parser.hpp"
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+namespace TreeSitter {
+
+	/**
+	 * Content addressed cache of parsed trees.
+	 *
+	 * Sources are looked up by a hash of their contents (and the language they
+	 * are parsed with), so identical buffers are only parsed once no matter
+	 * where they come from. Cached trees are never edited; a hit hands back a
+	 * `ts_tree_copy` of the cached tree, which only bumps a reference count.
+	 *
+	 * The cache evicts the least recently used trees once its estimated memory
+	 * use passes the budget. tree-sitter doesn't report how much memory a tree
+	 * uses, so each entry is charged for its source plus
+	 * `tree_bytes_per_source_byte` times the source size.
+	 *
+	 * All functions are thread safe, parsing happens outside of the lock.
+	 */
+	struct ParseCache {
+		struct Statistics {
+			uint64_t hits = 0;
+			uint64_t misses = 0;
+			uint64_t evictions = 0;
+			size_t entries = 0;
+			size_t memory = 0;
+		};
+
+		struct Key {
+			uint64_t hash;
+			size_t length;
+			const TSLanguage* language;
+
+			inline bool operator==(const Key&) const = default;
+		};
+
+		struct KeyHash {
+			inline size_t operator()(const Key& key) const { return key.hash ^ detail::fold_multiply(key.length ^ (uintptr_t)key.language, 0x9e3779b97f4a7c15ull); }
+		};
+
+		struct Entry {
+			Key key;
+			std::shared_ptr<const std::string> source;
+			Tree tree;
+			size_t cost;
+		};
+
+		size_t memory_budget;
+		size_t tree_bytes_per_source_byte = 8;
+
+		std::mutex mutex;
+		// Most recently used entries are at the front
+		std::list<Entry> entries;
+		std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> index;
+		Statistics statistics;
+
+		explicit ParseCache(size_t memory_budget = 256 * 1024 * 1024) : memory_budget(memory_budget) { }
+		ParseCache(const ParseCache&) = delete;
+		ParseCache& operator=(const ParseCache&) = delete;
+
+		/**
+		 * Get the key the given source is cached under when parsed with the given language.
+		 */
+		static inline Key key(const Language& language, const std::string_view source) { return {hash_bytes(source), source.size(), language}; }
+
+		/**
+		 * Look up the tree for the given source, returning nothing (and counting a
+		 * miss) if it isn't cached. The returned tree's source is owned by the cache
+		 * entry and stays valid even after the entry is evicted.
+		 */
+		std::optional<SourceTree> find(const Language& language, const std::string_view source) { return find(key(language, source), source); }
+		std::optional<SourceTree> find(const Key& key, const std::string_view source) {
+			std::scoped_lock lock(mutex);
+			auto found = index.find(key);
+			// The hash could collide, so only a full comparison counts as a hit
+			if(found == index.end() || *found->second->source != source) {
+				statistics.misses++;
+				return {};
+			}
+			statistics.hits++;
+			entries.splice(entries.begin(), entries, found->second);
+			return SourceTree(Tree(found->second->tree), *found->second->source, found->second->source);
+		}
+
+		/**
+		 * Add a tree parsed from the given source to the cache, evicting old trees
+		 * if the cache is over budget. The cache keeps its own copy of the tree, so
+		 * the caller's tree may still be edited. Returns the tree now cached for
+		 * the source, which is the existing one if another thread got there first.
+		 */
+		SourceTree insert(const std::string_view source, const Tree& tree) {
+			return insert(key(tree.language(), source), std::make_shared<const std::string>(source), tree);
+		}
+		SourceTree insert(const Key& key, std::shared_ptr<const std::string> source, const Tree& tree) {
+			std::scoped_lock lock(mutex);
+			auto found = index.find(key);
+			if(found != index.end() && *found->second->source == *source) {
+				entries.splice(entries.begin(), entries, found->second);
+				return SourceTree(Tree(found->second->tree), *found->second->source, found->second->source);
+			}
+			// A colliding source replaces the old entry
+			if(found != index.end()) remove(found->second);
+
+			size_t cost = source->size() * (1 + tree_bytes_per_source_byte);
+			entries.push_front({key, source, Tree(tree), cost});
+			index[key] = entries.begin();
+			statistics.memory += cost;
+			// The new entry itself is evicted straight away if it is larger than the budget
+			evict();
+
+			std::string_view text = *source;
+			return SourceTree(Tree(tree), text, std::move(source));
+		}
+
+		/**
+		 * Get the tree for the given source, parsing it with `parser` (and caching
+		 * the result) on a miss.
+		 */
+		SourceTree parse(Parser& parser, const std::string_view source) {
+			Key key = ParseCache::key(parser.language(), source);
+			if(auto hit = find(key, source)) return std::move(*hit);
+
+			auto owned = std::make_shared<const std::string>(source);
+			Tree tree = parser.parse_string(*owned);
+			if(!tree) return {};
+			return insert(key, std::move(owned), tree);
+		}
+
+		/**
+		 * Remove every tree from the cache. Trees which were handed out stay valid.
+		 */
+		void clear() {
+			std::scoped_lock lock(mutex);
+			entries.clear();
+			index.clear();
+			statistics.memory = 0;
+		}
+
+		/**
+		 * Change the memory budget, evicting trees if the cache is now over it.
+		 */
+		void set_memory_budget(size_t budget) {
+			std::scoped_lock lock(mutex);
+			memory_budget = budget;
+			evict();
+		}
+
+		/**
+		 * Get the hit and miss counters along with the current size of the cache.
+		 */
+		Statistics stats() {
+			std::scoped_lock lock(mutex);
+			Statistics out = statistics;
+			out.entries = entries.size();
+			return out;
+		}
+		inline Statistics get_stats() { return stats(); }
+
+		// Both of these expect the lock to be held
+		void remove(std::list<Entry>::iterator entry) {
+			statistics.memory -= entry->cost;
+			index.erase(entry->key);
+			entries.erase(entry);
+		}
+
+		void evict() {
+			while(statistics.memory > memory_budget && !entries.empty()) {
+				remove(std::prev(entries.end()));
+				statistics.evictions++;
+			}
+		}
+	};
+}
+
+#endif // __TREE_SITTERPP_PARSE_CACHE_HPP__
\ No newline at end of file
@@ -0,0 +1,187 @@
+#ifndef __TREE_SITTERPP_PARSE_TASK_HPP__
+#define __TREE_SITTERPP_PARSE_TASK_HPP__
+
+#include "parser.hpp"
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <optional>
+#include <stop_token>
+
+namespace TreeSitter {
+
+	/**
+	 * A parse which runs in time boxed slices.
+	 *
+	 * Each call to `step` parses for at most the slice budget and then returns,
+	 * resuming where the previous slice left off, until the tree is finished.
+	 * The parse can be cancelled through a `std::stop_token` (checked by the
+	 * parser while it runs, not only between slices) or an absolute deadline.
+	 *
+	 *   ts::ParseTask task(parser, source);
+	 *   task.set_stop_token(stop);
+	 *   while(task.step(frame_budget_left()) == ts::ParseTask::Running)
+	 *       render_frame();
+	 *
+	 * The parser is borrowed and can't be used for anything else until the task
+	 * finishes. A task which is cancelled or destroyed early resets the parser,
+	 * so the parser's next parse starts from scratch instead of resuming. A
+	 * moved-from task no longer borrows the parser and reports `Cancelled`.
+	 */
+	struct ParseTask {
+		using Clock = std::chrono::steady_clock;
+
+		enum Status {
+			Running,   // More steps are needed
+			Done,      // The tree is ready
+			Cancelled, // A stop was requested
+			TimedOut,  // The deadline passed before the tree was finished
+			Failed,    // The parser has no language
+		};
+
+		// Sets the cancellation flag the parser polls, from whichever thread requests the stop
+		struct Canceller {
+			size_t* flag;
+			void operator()() const { std::atomic_ref<size_t>(*flag).store(1, std::memory_order_relaxed); }
+		};
+
+		Parser* parser = nullptr;
+		const TSTree* old_tree = nullptr;
+		std::string_view source;
+		TSInputEncoding encoding = TSInputEncodingUTF8;
+		std::optional<TSInput> input;
+
+		std::chrono::microseconds slice = std::chrono::milliseconds(8);
+		Clock::time_point deadline = Clock::time_point::max();
+		// Heap allocated so the flag's address survives the task being moved
+		std::unique_ptr<size_t> flag = std::make_unique<size_t>(0);
+		std::unique_ptr<std::stop_callback<Canceller>> on_stop;
+
+		Status current_status = Running;
+		Tree result;
+
+		ParseTask(Parser& parser, const std::string_view source, const TSTree* old_tree = nullptr, TSInputEncoding encoding = TSInputEncodingUTF8)
+			: parser(&parser), old_tree(old_tree), source(source), encoding(encoding) { }
+		ParseTask(Parser& parser, const TSInput input, const TSTree* old_tree = nullptr) : parser(&parser), old_tree(old_tree), input(input) { }
+		ParseTask(const ParseTask&) = delete;
+		ParseTask(ParseTask&& move) { *this = std::move(move); }
+		ParseTask& operator=(const ParseTask&) = delete;
+		ParseTask& operator=(ParseTask&& move) {
+			if(this == &move) return *this;
+			abandon();
+			parser = move.parser;
+			old_tree = move.old_tree;
+			source = move.source;
+			encoding = move.encoding;
+			input = move.input;
+			slice = move.slice;
+			deadline = move.deadline;
+			on_stop = std::move(move.on_stop);
+			// Swapped rather than moved so the moved-from task still has a flag to cancel
+			std::swap(flag, move.flag);
+			current_status = move.current_status;
+			result = std::move(move.result);
+			move.parser = nullptr;
+			move.current_status = Cancelled;
+			return *this;
+		}
+		~ParseTask() { abandon(); }
+
+		/**
+		 * Set the longest a single `step` may parse for (8ms by default).
+		 */
+		inline void set_slice(std::chrono::microseconds budget) { slice = budget; }
+
+		/**
+		 * Set an absolute time after which the parse is abandoned.
+		 */
+		inline void set_deadline(Clock::time_point time) { deadline = time; }
+
+		/**
+		 * Cancel the parse when a stop is requested on the given token. The parser
+		 * notices the request while it is running, so this also interrupts a slice
+		 * in progress (ex. from another thread).
+		 */
+		void set_stop_token(std::stop_token stop) {
+			on_stop.reset();
+			if(stop.stop_possible()) on_stop = std::make_unique<std::stop_callback<Canceller>>(std::move(stop), Canceller{flag.get()});
+		}
+
+		/**
+		 * Request that the parse stops, the next (or current) step returns `Cancelled`.
+		 */
+		inline void cancel() { Canceller{flag.get()}(); }
+
+		/**
+		 * Get the current status of the parse.
+		 */
+		inline Status status() const { return current_status; }
+		inline Status get_status() const { return status(); }
+		inline bool finished() const { return current_status != Running; }
+
+		/**
+		 * Get the finished tree, which is null unless the status is `Done`.
+		 */
+		inline const Tree& tree() const { return result; }
+		inline const Tree& get_tree() const { return tree(); }
+		inline Tree take_tree() { return std::move(result); }
+
+		/**
+		 * Parse for at most the slice budget (or the given budget) and report
+		 * whether the tree is finished.
+		 */
+		inline Status step() { return step(slice); }
+		Status step(std::chrono::microseconds budget) {
+			if(current_status != Running || !parser) return current_status;
+			if(!parser->language()) return finish(Failed);
+			if(std::atomic_ref<size_t>(*flag).load(std::memory_order_relaxed)) return finish(Cancelled);
+
+			auto now = Clock::now();
+			if(now >= deadline) return finish(TimedOut);
+			if(deadline != Clock::time_point::max())
+				budget = std::min(budget, std::chrono::duration_cast<std::chrono::microseconds>(deadline - now));
+
+			// Borrow the parser's settings for the slice, a timeout of 0 would mean no timeout
+			uint64_t previous_timeout = parser->timeout_micros();
+			const size_t* previous_flag = parser->cancellation_flag();
+			parser->set_timeout_micros(std::max<int64_t>(budget.count(), 1));
+			parser->set_cancellation_flag(flag.get());
+
+			Tree tree = input ? parser->parse(old_tree, *input) : parser->parse_string_encoding(old_tree, source, encoding);
+
+			parser->set_timeout_micros(previous_timeout);
+			parser->set_cancellation_flag(previous_flag);
+
+			if(tree) {
+				result = std::move(tree);
+				current_status = Done;
+				on_stop.reset();
+				return Done;
+			}
+			if(std::atomic_ref<size_t>(*flag).load(std::memory_order_relaxed)) return finish(Cancelled);
+			if(Clock::now() >= deadline) return finish(TimedOut);
+			return Running;
+		}
+
+		/**
+		 * Step until the parse is finished, blocking the calling thread.
+		 */
+		Status run() {
+			while(step() == Running);
+			return current_status;
+		}
+
+		// Ends an unfinished parse, resetting the parser so it doesn't try to resume it later
+		Status finish(Status status) {
+			if(parser) parser->reset();
+			on_stop.reset();
+			return current_status = status;
+		}
+
+		void abandon() {
+			if(parser && current_status == Running) finish(Cancelled);
+		}
+	};
+}
+
+#endif // __TREE_SITTERPP_PARSE_TASK_HPP__
\ No newline at end of file
@@ -3,12 +3,15 @@
 
 #include "helpers.hpp"
 #include "tree.hpp"
+#include "language.hpp"
+#include "input.hpp"
+#include "mapped_file.hpp"
 #include <cstdio>
 
 namespace TreeSitter {
 
 	struct Parser : detail::UniqueHandle<TSParser> {
-		Parser() : detail::UniqueHandle<TSParser>(ts_parser_new()) {}
+		Parser() : detail::UniqueHandle<TSParser>((detail::ensure_allocator_hooks(), ts_parser_new())) {}
 		Parser(TSParser* parser) : detail::UniqueHandle<TSParser>(parser) { }
 		explicit inline Parser(const TSLanguage* lang) : Parser() { set_language(lang); }
 		using detail::UniqueHandle<TSParser>::UniqueHandle;
@@ -32,8 +35,8 @@ namespace TreeSitter {
 		/**
 		 * Get the parser's current language.
 		 */
-		const TSLanguage* language() const { return ts_parser_language(*this); }
-		const TSLanguage* get_language() const { return language(); }
+		Language language() const { return ts_parser_language(*this); }
+		Language get_language() const { return language(); }
 
 		/**
 		 * Set the ranges of text that the parser should include when parsing.
@@ -113,9 +116,29 @@ namespace TreeSitter {
 		*    the same arguments.
 		*/
 		inline Tree parse(const TSTree* old_tree, TSInput input) { return ts_parser_parse(*this, old_tree, input); }
-		inline Tree parse(const Tree old_tree, TSInput input) { return ts_parser_parse(*this, old_tree, input); }
+		inline Tree parse(const Tree& old_tree, TSInput input) { return ts_parser_parse(*this, old_tree, input); }
 		inline Tree parse(TSInput input) { return parse(nullptr, input); }
 
+		/**
+		 * Use the parser to parse some source code read through a reader, any
+		 * callable `read(byte, point) -> std::string_view` (see `make_input`), or
+		 * a `ChunkedInput` over a range of chunks. The text is borrowed straight
+		 * from the reader so non-contiguous buffers are parsed without being
+		 * flattened first.
+		 */
+		template<InputReader Reader>
+		inline Tree parse(const TSTree* old_tree, Reader&& reader, TSInputEncoding encoding = TSInputEncodingUTF8) { return parse(old_tree, make_input(reader, encoding)); }
+		template<InputReader Reader>
+		inline Tree parse(Reader&& reader, TSInputEncoding encoding = TSInputEncodingUTF8) { return parse(nullptr, reader, encoding); }
+
+		/**
+		 * Use the parser to parse some source code stored in a range of chunks.
+		 */
+		template<ChunkRange Chunks>
+		inline Tree parse_chunks(const TSTree* old_tree, Chunks&& chunks, TSInputEncoding encoding = TSInputEncodingUTF8) { return parse(old_tree, ChunkedInput(std::forward<Chunks>(chunks)), encoding); }
+		template<ChunkRange Chunks>
+		inline Tree parse_chunks(Chunks&& chunks, TSInputEncoding encoding = TSInputEncodingUTF8) { return parse_chunks(nullptr, std::forward<Chunks>(chunks), encoding); }
+
 		/**
 		 * Use the parser to parse some source code stored in one contiguous buffer.
 		 * The first two parameters are the same as in the `parse` function
@@ -123,9 +146,42 @@ namespace TreeSitter {
 		 * length in bytes.
 		 */
 		inline Tree parse_string(const TSTree* old_tree, const std::string_view string) { return ts_parser_parse_string(*this, old_tree, string.data(), string.size()); }
-		inline Tree parse_string(const Tree old_tree, const std::string_view string) { return ts_parser_parse_string(*this, old_tree, string.data(), string.size()); }
+		inline Tree parse_string(const Tree& old_tree, const std::string_view string) { return ts_parser_parse_string(*this, old_tree, string.data(), string.size()); }
 		inline Tree parse_string(const std::string_view string) { return parse_string(nullptr, string); }
 
+		/**
+		 * Use the parser to parse some source code, returning a tree which remembers
+		 * its source so the text of its nodes can be read back without copying.
+		 *
+		 * `owner` keeps the source alive, if it isn't given the caller must keep the
+		 * source alive while the tree is in use. The overload taking a `std::string`
+		 * takes ownership of it.
+		 */
+		inline SourceTree parse_source(const TSTree* old_tree, const std::string_view source, std::shared_ptr<const void> owner = {}) { return {parse_string(old_tree, source), source, std::move(owner)}; }
+		inline SourceTree parse_source(const std::string_view source, std::shared_ptr<const void> owner = {}) { return parse_source(nullptr, source, std::move(owner)); }
+		// Constrained so only an actual std::string rvalue binds here, string literals and views take the overload above
+		template<std::same_as<std::string> String>
+		SourceTree parse_source(const TSTree* old_tree, String&& source) {
+			auto owned = std::make_shared<const std::string>(std::move(source));
+			return parse_source(old_tree, *owned, owned);
+		}
+		template<std::same_as<std::string> String>
+		inline SourceTree parse_source(String&& source) { return parse_source(nullptr, std::move(source)); }
+
+		/**
+		 * Use the parser to parse the file at the given path.
+		 *
+		 * The file is memory mapped and parsed straight from the mapping. The
+		 * returned tree keeps the mapping alive, so the text of its nodes can be
+		 * read without copying. Returns a null tree if the file couldn't be read.
+		 */
+		SourceTree parse_file(const TSTree* old_tree, const std::filesystem::path& path) {
+			auto file = std::make_shared<MappedFile>(path);
+			if(!*file) return {};
+			return parse_source(old_tree, file->view(), file);
+		}
+		inline SourceTree parse_file(const std::filesystem::path& path) { return parse_file(nullptr, path); }
+
 		/**
 		 * Use the parser to parse some source code stored in one contiguous buffer with
 		 * a given encoding. The first four parameters work the same as in the
@@ -133,7 +189,7 @@ namespace TreeSitter {
 		 * the text is encoded as UTF8 or UTF16.
 		 */
 		inline Tree parse_string_encoding(const TSTree* old_tree, const std::string_view string, const TSInputEncoding encoding) { return ts_parser_parse_string_encoding(*this, old_tree, string.data(), string.size(), encoding); }
-		inline Tree parse_string_encoding(const Tree old_tree, const std::string_view string, const TSInputEncoding encoding) { return ts_parser_parse_string_encoding(*this, old_tree, string.data(), string.size(), encoding); }
+		inline Tree parse_string_encoding(const Tree& old_tree, const std::string_view string, const TSInputEncoding encoding) { return ts_parser_parse_string_encoding(*this, old_tree, string.data(), string.size(), encoding); }
 		inline Tree parse_string_encoding(const std::string_view string, const TSInputEncoding encoding) { return parse_string_encoding(nullptr, string, encoding); }
 
 		/**
@@ -0,0 +1,298 @@
+#ifndef __TREE_SITTERPP_QUERY_HPP__
+#define __TREE_SITTERPP_QUERY_HPP__
+
+#include "helpers.hpp"
+#include "node.hpp"
+#include <iterator>
+#include <ranges>
+
+namespace TreeSitter {
+
+	struct Query : detail::UniqueHandle<TSQuery> {
+		using detail::UniqueHandle<TSQuery>::UniqueHandle;
+		using detail::UniqueHandle<TSQuery>::operator=;
+
+		Query(TSQuery* query) : detail::UniqueHandle<TSQuery>(query) { }
+
+		/**
+		 * Create a new query from a string containing one or more S-expression
+		 * patterns. The query is associated with a particular language, and can
+		 * only be run on syntax nodes parsed with that language.
+		 *
+		 * If all of the given patterns are valid, this returns a `Query`.
+		 * If a pattern is invalid, this returns a null query, and provides two pieces
+		 * of information about the problem:
+		 * 1. The byte offset of the error is written to the `error_offset` parameter.
+		 * 2. The type of error is written to the `error_type` parameter.
+		 */
+		Query(const TSLanguage* language, const std::string_view source, uint32_t* error_offset = nullptr, TSQueryError* error_type = nullptr)
+			: detail::UniqueHandle<TSQuery>(create(language, source, error_offset, error_type)) { }
+
+		inline operator TSQuery*() { return get(); }
+		inline operator const TSQuery*() const { return get(); }
+
+		/**
+		 * Get the number of patterns, captures, or string literals in the query.
+		 */
+		inline uint32_t pattern_count() const { return ts_query_pattern_count(*this); }
+		inline uint32_t get_pattern_count() const { return pattern_count(); }
+		inline uint32_t capture_count() const { return ts_query_capture_count(*this); }
+		inline uint32_t get_capture_count() const { return capture_count(); }
+		inline uint32_t string_count() const { return ts_query_string_count(*this); }
+		inline uint32_t get_string_count() const { return string_count(); }
+
+		/**
+		 * Get the byte offset where the given pattern starts in the query's source.
+		 *
+		 * This can be useful when combining queries by concatenating their source
+		 * code strings.
+		 */
+		inline uint32_t start_byte_for_pattern(uint32_t pattern_index) const { return ts_query_start_byte_for_pattern(*this, pattern_index); }
+
+		/**
+		 * Get all of the predicates for the given pattern in the query.
+		 *
+		 * The predicates are represented as a single array of steps. There are three
+		 * types of steps in this array, which correspond to the three legal values for
+		 * the `type` field:
+		 * - `TSQueryPredicateStepTypeCapture` - Steps with this type represent names
+		 *    of captures. Their `value_id` can be used with the
+		 *   `capture_name_for_id` function to obtain the name of the capture.
+		 * - `TSQueryPredicateStepTypeString` - Steps with this type represent literal
+		 *    strings. Their `value_id` can be used with the
+		 *    `string_value_for_id` function to obtain their string value.
+		 * - `TSQueryPredicateStepTypeDone` - Steps with this type are *sentinels*
+		 *    that represent the end of an individual predicate. If a pattern has two
+		 *    predicates, then there will be two steps with this `type` in the array.
+		 */
+		inline const TSQueryPredicateStep* predicates_for_pattern(uint32_t pattern_index, uint32_t* length) const { return ts_query_predicates_for_pattern(*this, pattern_index, length); }
+		std::span<const TSQueryPredicateStep> predicates_for_pattern(uint32_t pattern_index) const {
+			uint32_t len;
+			auto* steps = predicates_for_pattern(pattern_index, &len);
+			return std::span{steps, (size_t)len};
+		}
+
+		/**
+		 * Check if the given pattern in the query has a single root node.
+		 */
+		inline bool is_pattern_rooted(uint32_t pattern_index) const { return ts_query_is_pattern_rooted(*this, pattern_index); }
+
+		/**
+		 * Check if the pattern step at the given byte offset is guaranteed to match
+		 * once the preceding steps have matched.
+		 */
+		inline bool is_pattern_guaranteed_at_step(uint32_t byte_offset) const { return ts_query_is_pattern_guaranteed_at_step(*this, byte_offset); }
+
+		/**
+		 * Get the name and length of one of the query's captures, or one of the
+		 * query's string literals. Each capture and string is associated with a
+		 * numeric id based on the order that it appeared in the query's source.
+		 */
+		std::string_view capture_name_for_id(uint32_t id) const {
+			uint32_t len;
+			auto* name = ts_query_capture_name_for_id(*this, id, &len);
+			return {name, len};
+		}
+		std::string_view string_value_for_id(uint32_t id) const {
+			uint32_t len;
+			auto* value = ts_query_string_value_for_id(*this, id, &len);
+			return {value, len};
+		}
+
+		/**
+		 * Get the numeric id of the capture with the given name.
+		 *
+		 * This is a linear search over the query's captures, so resolve names once
+		 * up front rather than inside of a match loop.
+		 */
+		std::optional<uint32_t> capture_index_for_name(const std::string_view name) const {
+			for(uint32_t i = 0, count = capture_count(); i < count; i++)
+				if(capture_name_for_id(i) == name)
+					return i;
+			return {};
+		}
+
+		/**
+		 * Disable a certain capture within a query.
+		 *
+		 * This prevents the capture from being returned in matches, and also avoids
+		 * any resource usage associated with recording the capture. Currently, there
+		 * is no way to undo this.
+		 */
+		inline void disable_capture(const std::string_view name) { ts_query_disable_capture(*this, name.data(), name.size()); }
+
+		/**
+		 * Disable a certain pattern within a query.
+		 *
+		 * This prevents the pattern from matching and removes most of the overhead
+		 * associated with the pattern. Currently, there is no way to undo this.
+		 */
+		inline void disable_pattern(uint32_t pattern_index) { ts_query_disable_pattern(*this, pattern_index); }
+
+		static TSQuery* create(const TSLanguage* language, const std::string_view source, uint32_t* error_offset, TSQueryError* error_type) {
+			uint32_t offset;
+			TSQueryError type;
+			detail::ensure_allocator_hooks();
+			return ts_query_new(language, source.data(), source.size(), error_offset ? error_offset : &offset, error_type ? error_type : &type);
+		}
+	};
+
+	void ts_query_delete(Query q) = delete;
+
+
+	struct QueryMatch : TSQueryMatch {
+		QueryMatch() : TSQueryMatch{0, 0, 0, nullptr} { }
+		QueryMatch(const TSQueryMatch& match) : TSQueryMatch(match) { }
+
+		/**
+		 * Get the captures of this match. The captures are owned by the cursor which
+		 * produced the match and are only valid until it is advanced.
+		 */
+		inline std::span<const TSQueryCapture> capture_span() const { return {captures, capture_count}; }
+
+		/**
+		 * Get the node of the first capture with the given capture id, or a null node
+		 * if this match didn't capture anything with that id.
+		 */
+		Node node_for_capture(uint32_t capture_index) const {
+			for(auto& capture: capture_span())
+				if(capture.index == capture_index)
+					return capture.node;
+			return {};
+		}
+	};
+
+	struct QueryCapture {
+		QueryMatch match;
+		uint32_t capture_index = 0;
+
+		/**
+		 * Get the capture (node and capture id) which this result refers to.
+		 */
+		inline const TSQueryCapture& capture() const { return match.captures[capture_index]; }
+		inline Node node() const { return capture().node; }
+		inline uint32_t index() const { return capture().index; }
+	};
+
+	namespace detail {
+		// Input iterator which pulls results out of a query cursor one at a time. The
+		// iterator only stores the most recent result, so iterating never allocates.
+		template<typename T, bool (*Next)(TSQueryCursor*, T&)>
+		struct QueryIterator {
+			using value_type = T;
+			using difference_type = std::ptrdiff_t;
+			using iterator_concept = std::input_iterator_tag;
+
+			TSQueryCursor* cursor = nullptr;
+			T current = {};
+			bool done = true;
+
+			QueryIterator() = default;
+			explicit QueryIterator(TSQueryCursor* cursor) : cursor(cursor), done(cursor == nullptr) { ++*this; }
+
+			inline const T& operator*() const { return current; }
+			inline const T* operator->() const { return &current; }
+			QueryIterator& operator++() { if(!done) done = !Next(cursor, current); return *this; }
+			inline void operator++(int) { ++*this; }
+			inline friend bool operator==(const QueryIterator& it, std::default_sentinel_t) { return it.done; }
+		};
+
+		inline bool next_match(TSQueryCursor* cursor, QueryMatch& match) { return ts_query_cursor_next_match(cursor, &match); }
+		inline bool next_capture(TSQueryCursor* cursor, QueryCapture& capture) { return ts_query_cursor_next_capture(cursor, &capture.match, &capture.capture_index); }
+
+		// Single pass view over the remaining results of a query cursor
+		template<typename Iterator>
+		struct QueryRange : std::ranges::view_interface<QueryRange<Iterator>> {
+			TSQueryCursor* cursor = nullptr;
+
+			QueryRange() = default;
+			explicit QueryRange(TSQueryCursor* cursor) : cursor(cursor) { }
+
+			inline Iterator begin() const { return Iterator(cursor); }
+			inline std::default_sentinel_t end() const { return {}; }
+		};
+	}
+
+	using QueryMatchIterator = detail::QueryIterator<QueryMatch, detail::next_match>;
+	using QueryCaptureIterator = detail::QueryIterator<QueryCapture, detail::next_capture>;
+	using QueryMatches = detail::QueryRange<QueryMatchIterator>;
+	using QueryCaptures = detail::QueryRange<QueryCaptureIterator>;
+
+
+	struct QueryCursor : detail::UniqueHandle<TSQueryCursor> {
+		QueryCursor() : detail::UniqueHandle<TSQueryCursor>((detail::ensure_allocator_hooks(), ts_query_cursor_new())) {}
+		QueryCursor(TSQueryCursor* cursor) : detail::UniqueHandle<TSQueryCursor>(cursor) { }
+		using detail::UniqueHandle<TSQueryCursor>::UniqueHandle;
+		using detail::UniqueHandle<TSQueryCursor>::operator=;
+
+		inline operator TSQueryCursor*() { return get(); }
+		inline operator const TSQueryCursor*() const { return get(); }
+
+		/**
+		 * Start running a given query on a given node.
+		 *
+		 * A query cursor can be reused for many queries and nodes; the memory it
+		 * allocates for in-progress matches is kept between executions.
+		 */
+		inline void exec(const TSQuery* query, const Node& node) { ts_query_cursor_exec(*this, query, node); }
+
+		/**
+		 * Manage the maximum number of in-progress matches allowed by this query
+		 * cursor.
+		 *
+		 * Query cursors have an optional maximum capacity for storing lists of
+		 * in-progress captures. If this capacity is exceeded, then the
+		 * earliest-starting match will silently be dropped to make room for further
+		 * matches. This maximum capacity is optional — by default, query cursors allow
+		 * any number of pending matches, dynamically allocating new space for them as
+		 * needed as the query is executed.
+		 */
+		inline bool did_exceed_match_limit() const { return ts_query_cursor_did_exceed_match_limit(*this); }
+		inline uint32_t match_limit() const { return ts_query_cursor_match_limit(*this); }
+		inline uint32_t get_match_limit() const { return match_limit(); }
+		inline void set_match_limit(uint32_t limit) { ts_query_cursor_set_match_limit(*this, limit); }
+
+		/**
+		 * Set the range of bytes or (row, column) positions in which the query
+		 * will be executed.
+		 */
+		inline void set_byte_range(uint32_t start, uint32_t end) { ts_query_cursor_set_byte_range(*this, start, end); }
+		inline void set_byte_range(ByteRange range) { set_byte_range(range.first, range.second); }
+		inline void set_point_range(TSPoint start, TSPoint end) { ts_query_cursor_set_point_range(*this, start, end); }
+		inline void set_point_range(PointRange range) { set_point_range(range.first, range.second); }
+
+		/**
+		 * Advance to the next match of the currently running query.
+		 *
+		 * If there is a match, write it to `match` and return `true`.
+		 * Otherwise, return `false`.
+		 */
+		inline bool next_match(QueryMatch& match) { return detail::next_match(*this, match); }
+		inline void remove_match(uint32_t id) { ts_query_cursor_remove_match(*this, id); }
+
+		/**
+		 * Advance to the next capture of the currently running query.
+		 *
+		 * If there is a capture, write its match to `capture.match` and its index
+		 * within the match's capture list to `capture.capture_index`. Otherwise,
+		 * return `false`.
+		 */
+		inline bool next_capture(QueryCapture& capture) { return detail::next_capture(*this, capture); }
+
+		/**
+		 * Get a single pass range over the remaining matches (or captures, ordered by
+		 * position in the document) of the currently running query.
+		 *
+		 * The range borrows this cursor, every step reuses the cursor's storage so no
+		 * allocations are made per match. Results are invalidated by the next step.
+		 */
+		inline QueryMatches matches() { return QueryMatches(*this); }
+		inline QueryMatches matches(const TSQuery* query, const Node& node) { exec(query, node); return matches(); }
+		inline QueryCaptures captures() { return QueryCaptures(*this); }
+		inline QueryCaptures captures(const TSQuery* query, const Node& node) { exec(query, node); return captures(); }
+	};
+
+	void ts_query_cursor_delete(QueryCursor c) = delete;
+}
+
+#endif // __TREE_SITTERPP_QUERY_HPP__
\ No newline at end of file
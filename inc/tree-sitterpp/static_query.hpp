@@ -0,0 +1,145 @@
+#ifndef __TREE_SITTERPP_STATIC_QUERY_HPP__
+#define __TREE_SITTERPP_STATIC_QUERY_HPP__
+
+#include "query.hpp"
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <cstdlib>
+
+namespace TreeSitter {
+	namespace detail {
+		// String literal which can be used as a template parameter
+		template<size_t N>
+		struct FixedString {
+			char data[N];
+
+			constexpr FixedString(const char (&str)[N]) { std::copy_n(str, N, data); }
+			constexpr std::string_view view() const { return {data, N - 1}; }
+		};
+
+		// Characters which can appear in a capture name (matches the query parser's identifier rules)
+		constexpr bool is_capture_char(char c) {
+			return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9')
+				|| c == '_' || c == '-' || c == '.' || c == '?' || c == '!';
+		}
+
+		// Calls `f` with every capture name in the query source in order of appearance,
+		// skipping over string literals and comments
+		template<typename F>
+		constexpr void for_each_capture_name(std::string_view source, F&& f) {
+			for(size_t i = 0; i < source.size(); i++) {
+				if(source[i] == '"') {
+					for(i++; i < source.size() && source[i] != '"'; i++)
+						if(source[i] == '\\') i++;
+				} else if(source[i] == ';') {
+					while(i < source.size() && source[i] != '\n') i++;
+				} else if(source[i] == '@') {
+					size_t end = i + 1;
+					while(end < source.size() && is_capture_char(source[end])) end++;
+					f(source.substr(i + 1, end - i - 1));
+					i = end - 1;
+				}
+			}
+		}
+
+		// Capture ids are assigned by the query parser in order of first appearance,
+		// later references (ex. from predicates) reuse the existing id
+		template<size_t Max>
+		constexpr auto collect_capture_names(std::string_view source) {
+			std::array<std::string_view, Max> names{};
+			size_t count = 0;
+			for_each_capture_name(source, [&](std::string_view name) {
+				if(std::find(names.begin(), names.begin() + count, name) == names.begin() + count)
+					names[count++] = name;
+			});
+			return std::pair{names, count};
+		}
+
+		constexpr size_t count_capture_names(std::string_view source) {
+			size_t max = 0;
+			for_each_capture_name(source, [&](std::string_view) { max++; });
+			return max;
+		}
+
+		// Deliberately not constexpr, reaching it during constant evaluation makes a typo'd capture name fail to compile
+		inline void unknown_capture_name() {}
+	}
+
+	/**
+	 * A query whose source is known at compile time.
+	 *
+	 * The query is compiled for the given language the first time it is used and
+	 * then cached for the rest of the program. Capture names are resolved at
+	 * compile time, so match dispatch can switch on capture ids:
+	 *
+	 *   using Calls = ts::StaticQuery<ts::cpp::language, "(call_expression function: (identifier) @name) @call">;
+	 *   for(auto& capture: Calls::captures(cursor, root))
+	 *     switch(capture.index()) {
+	 *     case Calls::capture("name"): ...
+	 *     case Calls::capture("call"): ...
+	 *     }
+	 *
+	 * Asking for a capture which doesn't appear in the query is a compile error.
+	 */
+	template<auto language, detail::FixedString source>
+	struct StaticQuery {
+		static constexpr std::string_view string = source.view();
+		static constexpr auto collected = detail::collect_capture_names<detail::count_capture_names(string)>(string);
+		static constexpr uint32_t capture_count = collected.second;
+
+		/**
+		 * Get the names of the query's captures, indexed by capture id.
+		 */
+		static constexpr std::span<const std::string_view> capture_names() { return {collected.first.data(), capture_count}; }
+
+		/**
+		 * Get the id of the capture with the given name.
+		 */
+		static consteval uint32_t capture(std::string_view name) {
+			for(uint32_t i = 0; i < capture_count; i++)
+				if(collected.first[i] == name)
+					return i;
+			detail::unknown_capture_name();
+			return capture_count;
+		}
+
+		/**
+		 * Get the compiled query, compiling it on first use. Safe to call from
+		 * multiple threads.
+		 *
+		 * The source is fixed at compile time, so a query which doesn't compile
+		 * for the language (or whose captures don't match the ids resolved at
+		 * compile time) is a programming error: the error is printed and the
+		 * program aborts, in release builds too.
+		 */
+		static const Query& query() {
+			static const Query query = [] {
+				uint32_t error_offset = 0;
+				TSQueryError error_type = TSQueryErrorNone;
+				Query query(language(), string, &error_offset, &error_type);
+				if(!query) {
+					fprintf(stderr, "StaticQuery failed to compile (error %d at offset %u): %.*s\n", (int)error_type, error_offset, (int)string.size(), string.data());
+					std::abort();
+				}
+				bool captures_match = query.capture_count() == capture_count;
+				for(uint32_t i = 0; captures_match && i < capture_count; i++)
+					captures_match = query.capture_name_for_id(i) == collected.first[i];
+				if(!captures_match) {
+					fprintf(stderr, "StaticQuery captures don't match the ids resolved at compile time: %.*s\n", (int)string.size(), string.data());
+					std::abort();
+				}
+				return query;
+			}();
+			return query;
+		}
+
+		/**
+		 * Run the query on the given node, returning a range over its matches or captures.
+		 */
+		static QueryMatches matches(QueryCursor& cursor, const Node& node) { return cursor.matches(query(), node); }
+		static QueryCaptures captures(QueryCursor& cursor, const Node& node) { return cursor.captures(query(), node); }
+	};
+}
+
+#endif // __TREE_SITTERPP_STATIC_QUERY_HPP__
\ No newline at end of file
@@ -0,0 +1,142 @@
+#ifndef __TREE_SITTERPP_SYMBOL_SEARCH_HPP__
+#define __TREE_SITTERPP_SYMBOL_SEARCH_HPP__
+
+#include "flat_tree.hpp"
+#include <array>
+#include <vector>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+	#include <immintrin.h>
+	#define TREE_SITTERPP_X86_SIMD
+#endif
+
+namespace TreeSitter {
+
+	// Implementations which `find_symbols` can pick between at runtime
+	enum class SymbolSearchBackend { Scalar, SSE2, AVX2 };
+
+	namespace detail {
+		// Past this many targets a lookup table beats comparing against each target
+		constexpr size_t max_simd_search_targets = 8;
+
+		using FindSymbolsFunction = void (*)(const TSSymbol* column, uint32_t count, std::span<const TSSymbol> targets, uint32_t offset, std::vector<uint32_t>& out);
+
+		inline void find_symbols_scalar(const TSSymbol* column, uint32_t count, std::span<const TSSymbol> targets, uint32_t offset, std::vector<uint32_t>& out) {
+			for(uint32_t i = 0; i < count; i++)
+				for(TSSymbol target: targets)
+					if(column[i] == target) {
+						out.push_back(offset + i);
+						break;
+					}
+		}
+
+		inline void find_symbols_table(const TSSymbol* column, uint32_t count, std::span<const TSSymbol> targets, uint32_t offset, std::vector<uint32_t>& out) {
+			std::array<uint64_t, (1 << 16) / 64> table{};
+			for(TSSymbol target: targets)
+				table[target / 64] |= uint64_t(1) << (target % 64);
+			for(uint32_t i = 0; i < count; i++)
+				if(table[column[i] / 64] & (uint64_t(1) << (column[i] % 64)))
+					out.push_back(offset + i);
+		}
+
+#ifdef TREE_SITTERPP_X86_SIMD
+		// Each 16 bit lane which matched sets two bits in a byte movemask, emit the index of each lane
+		inline void push_lane_matches(uint32_t mask, uint32_t base, std::vector<uint32_t>& out) {
+			while(mask) {
+				uint32_t bit = __builtin_ctz(mask);
+				out.push_back(base + bit / 2);
+				mask &= ~(3u << bit);
+			}
+		}
+
+		__attribute__((target("sse2")))
+		inline void find_symbols_sse2(const TSSymbol* column, uint32_t count, std::span<const TSSymbol> targets, uint32_t offset, std::vector<uint32_t>& out) {
+			__m128i needles[max_simd_search_targets];
+			for(size_t t = 0; t < targets.size(); t++)
+				needles[t] = _mm_set1_epi16((short)targets[t]);
+
+			uint32_t i = 0;
+			for(; i + 8 <= count; i += 8) {
+				__m128i symbols = _mm_loadu_si128((const __m128i*)(column + i));
+				__m128i hits = _mm_setzero_si128();
+				for(size_t t = 0; t < targets.size(); t++)
+					hits = _mm_or_si128(hits, _mm_cmpeq_epi16(symbols, needles[t]));
+				push_lane_matches(_mm_movemask_epi8(hits), offset + i, out);
+			}
+			find_symbols_scalar(column + i, count - i, targets, offset + i, out);
+		}
+
+		__attribute__((target("avx2")))
+		inline void find_symbols_avx2(const TSSymbol* column, uint32_t count, std::span<const TSSymbol> targets, uint32_t offset, std::vector<uint32_t>& out) {
+			__m256i needles[max_simd_search_targets];
+			for(size_t t = 0; t < targets.size(); t++)
+				needles[t] = _mm256_set1_epi16((short)targets[t]);
+
+			uint32_t i = 0;
+			for(; i + 16 <= count; i += 16) {
+				__m256i symbols = _mm256_loadu_si256((const __m256i*)(column + i));
+				__m256i hits = _mm256_setzero_si256();
+				for(size_t t = 0; t < targets.size(); t++)
+					hits = _mm256_or_si256(hits, _mm256_cmpeq_epi16(symbols, needles[t]));
+				push_lane_matches(_mm256_movemask_epi8(hits), offset + i, out);
+			}
+			find_symbols_scalar(column + i, count - i, targets, offset + i, out);
+		}
+#endif
+
+		inline FindSymbolsFunction find_symbols_function(SymbolSearchBackend backend) {
+			switch(backend) {
+#ifdef TREE_SITTERPP_X86_SIMD
+			case SymbolSearchBackend::AVX2: return find_symbols_avx2;
+			case SymbolSearchBackend::SSE2: return find_symbols_sse2;
+#endif
+			default: return find_symbols_scalar;
+			}
+		}
+	}
+
+	/**
+	 * Get the fastest symbol search implementation the current CPU supports.
+	 * This is checked once and then cached.
+	 */
+	inline SymbolSearchBackend symbol_search_backend() {
+		static const SymbolSearchBackend backend = [] {
+#ifdef TREE_SITTERPP_X86_SIMD
+			__builtin_cpu_init();
+			if(__builtin_cpu_supports("avx2")) return SymbolSearchBackend::AVX2;
+			if(__builtin_cpu_supports("sse2")) return SymbolSearchBackend::SSE2;
+#endif
+			return SymbolSearchBackend::Scalar;
+		}();
+		return backend;
+	}
+
+	/**
+	 * Append to `out` the index (plus `offset`) of every entry in the symbol
+	 * column which is one of `targets`, in increasing order.
+	 *
+	 * Small target sets are compared many symbols at a time with SIMD, larger
+	 * ones use a lookup table.
+	 */
+	inline void find_symbols(std::span<const TSSymbol> column, std::span<const TSSymbol> targets, std::vector<uint32_t>& out, uint32_t offset = 0, SymbolSearchBackend backend = symbol_search_backend()) {
+		if(targets.empty() || column.empty()) return;
+		if(targets.size() > detail::max_simd_search_targets)
+			return detail::find_symbols_table(column.data(), column.size(), targets, offset, out);
+		detail::find_symbols_function(backend)(column.data(), column.size(), targets, offset, out);
+	}
+
+	/**
+	 * Find every node in the subtree rooted at `root` (including `root`) whose
+	 * symbol is one of `targets`, returning their indices in preorder.
+	 */
+	inline std::vector<uint32_t> find_symbols(const FlatTreeView& tree, uint32_t root, std::span<const TSSymbol> targets) {
+		std::vector<uint32_t> out;
+		if(root >= tree.size()) return out;
+		find_symbols(tree.symbols.subspan(root, tree.subtree_end(root) - root), targets, out, root);
+		return out;
+	}
+	inline std::vector<uint32_t> find_symbols(const FlatTreeView& tree, std::span<const TSSymbol> targets) { return find_symbols(tree, 0, targets); }
+	inline std::vector<uint32_t> find_symbols(const FlatTreeView& tree, uint32_t root, std::initializer_list<TSSymbol> targets) { return find_symbols(tree, root, std::span{targets.begin(), targets.size()}); }
+}
+
+#endif // __TREE_SITTERPP_SYMBOL_SEARCH_HPP__
\ No newline at end of file
@@ -0,0 +1,99 @@
+#ifndef __TREE_SITTERPP_TRAVERSAL_HPP__
+#define __TREE_SITTERPP_TRAVERSAL_HPP__
+
+#include "node.hpp"
+#include "tree_cursor.hpp"
+#include <iterator>
+#include <optional>
+#include <ranges>
+
+namespace TreeSitter {
+	namespace detail {
+		// Input iterator which walks a single tree cursor, moving the cursor is the only work done per step
+		template<Traversal order, typename Cursor = TreeCursor>
+		struct CursorIterator {
+			using value_type = Node;
+			using difference_type = std::ptrdiff_t;
+			using iterator_concept = std::input_iterator_tag;
+
+			// Empty once the walk is finished
+			std::optional<Cursor> cursor;
+
+			CursorIterator() = default;
+			explicit CursorIterator(const Node& root) {
+				if(root.is_null()) return;
+				cursor.emplace(root);
+
+				if constexpr(order == Traversal::Children || order == Traversal::NamedChildren) {
+					if(!cursor->goto_first_child()) cursor.reset();
+					else if constexpr(order == Traversal::NamedChildren) skip_anonymous();
+				} else if constexpr(order == Traversal::Postorder)
+					while(cursor->goto_first_child());
+			}
+
+			inline Node operator*() const { return cursor->current_node(); }
+			inline void operator++(int) { ++*this; }
+			inline friend bool operator==(const CursorIterator& it, std::default_sentinel_t) { return !it.cursor; }
+
+			CursorIterator& operator++() {
+				if constexpr(order == Traversal::Children) {
+					if(!cursor->goto_next_sibling()) cursor.reset();
+				} else if constexpr(order == Traversal::NamedChildren) {
+					if(!cursor->goto_next_sibling()) cursor.reset();
+					else skip_anonymous();
+				} else if constexpr(order == Traversal::Preorder) {
+					if(cursor->goto_first_child()) return *this;
+					while(!cursor->goto_next_sibling())
+						if(!cursor->goto_parent()) {
+							cursor.reset();
+							break;
+						}
+				} else if constexpr(order == Traversal::Postorder) {
+					if(cursor->goto_next_sibling())
+						while(cursor->goto_first_child());
+					else if(!cursor->goto_parent()) cursor.reset();
+				}
+				return *this;
+			}
+
+			void skip_anonymous() {
+				while(!cursor->current_node().is_named())
+					if(!cursor->goto_next_sibling()) {
+						cursor.reset();
+						return;
+					}
+			}
+		};
+
+		template<Traversal order, typename Cursor>
+		struct CursorRange : std::ranges::view_interface<CursorRange<order, Cursor>> {
+			Node root;
+
+			CursorRange() = default;
+			explicit CursorRange(const Node& root) : root(root) { }
+
+			inline CursorIterator<order, Cursor> begin() const { return CursorIterator<order, Cursor>(root); }
+			inline std::default_sentinel_t end() const { return {}; }
+		};
+	}
+
+	inline ChildRange Node::children() const { return ChildRange(*this); }
+	inline NamedChildRange Node::named_children() const { return NamedChildRange(*this); }
+	inline PreorderRange Node::preorder() const { return PreorderRange(*this); }
+	inline PostorderRange Node::postorder() const { return PostorderRange(*this); }
+
+	/**
+	 * View adaptor which keeps only nodes with one of the given symbols, ex:
+	 *
+	 *   for(auto call: tree.preorder() | ts::filter(ts::cpp::Symbols::call_expression)) ...
+	 */
+	template<std::convertible_to<TSSymbol>... Symbols>
+	inline auto filter(Symbols... symbols) {
+		return std::views::filter([=](const Node& node) {
+			TSSymbol symbol = node.symbol();
+			return ((symbol == (TSSymbol)symbols) || ...);
+		});
+	}
+}
+
+#endif // __TREE_SITTERPP_TRAVERSAL_HPP__
\ No newline at end of file
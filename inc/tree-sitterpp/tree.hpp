@@ -3,9 +3,27 @@
 
 #include "helpers.hpp"
 #include "node.hpp"
+#include "language.hpp"
 
 namespace TreeSitter {
 
+	// Owning array of the ranges returned by `Tree::get_changed_ranges`
+	struct ChangedRanges {
+		detail::UniqueHandle<TSRange> ranges;
+		uint32_t length = 0;
+
+		ChangedRanges() = default;
+		ChangedRanges(TSRange* ranges, uint32_t length) : ranges(ranges), length(ranges ? length : 0) { }
+
+		inline const TSRange* data() const { return ranges.get(); }
+		inline const TSRange* begin() const { return data(); }
+		inline const TSRange* end() const { return data() + length; }
+		inline uint32_t size() const { return length; }
+		inline bool empty() const { return length == 0; }
+		inline const TSRange& operator[](uint32_t i) const { return data()[i]; }
+		inline operator std::span<const TSRange>() const { return {data(), (size_t)length}; }
+	};
+
 	struct Tree : detail::UniqueHandle<TSTree> {
 		using detail::UniqueHandle<TSTree>::UniqueHandle;
 		using detail::UniqueHandle<TSTree>::operator=;
@@ -25,11 +43,18 @@ namespace TreeSitter {
 		 */
 		inline Node root_node() const { return ts_tree_root_node(*this); }
 
+		/**
+		 * Get a range over every node in the tree, visiting parents before
+		 * (preorder) or after (postorder) their children. See `Node::preorder`.
+		 */
+		inline PreorderRange preorder() const { return root_node().preorder(); }
+		inline PostorderRange postorder() const { return root_node().postorder(); }
+
 		/**
 		 * Get the language that was used to parse the syntax tree.
 		 */
-		inline const TSLanguage* language() const { return ts_tree_language(*this); }
-		inline const TSLanguage* get_language() const { return language(); }
+		inline Language language() const { return ts_tree_language(*this); }
+		inline Language get_language() const { return language(); }
 
 		/**
 		 * Edit the syntax tree to keep it in sync with source code that has been
@@ -51,19 +76,61 @@ namespace TreeSitter {
 		 * You need to pass the old tree that was passed to parse, as well as the new
 		 * tree that was returned from that function.
 		 *
-		 * The returned array is allocated using `malloc` and the caller is responsible
-		 * for freeing it using `free`. The length of the array will be written to the
-		 * given `length` pointer.
+		 * The returned array owns the ranges and frees them when it is destroyed.
+		 * The raw overload returns an array allocated using `malloc`, the caller is
+		 * responsible for freeing it using `free` (or `ts_record_free` when the
+		 * allocator hooks are enabled). The length of the array will be
+		 * written to the given `length` pointer.
 		 */
-		inline const TSRange* get_changed_ranges(const Tree new_tree, uint32_t* length) const { return ts_tree_get_changed_ranges(*this, new_tree, length); }
-		std::span<const TSRange> get_changed_ranges(const Tree new_tree) const {
+		inline TSRange* get_changed_ranges(const Tree& new_tree, uint32_t* length) const { return ts_tree_get_changed_ranges(*this, new_tree, length); }
+		ChangedRanges get_changed_ranges(const Tree& new_tree) const {
 			uint32_t len;
-			auto range = get_changed_ranges(new_tree, &len);
-			return std::span{range, len};
+			auto* ranges = get_changed_ranges(new_tree, &len);
+			return {ranges, len};
 		}
 
 	};
 
+	/**
+	 * A tree together with the source it was parsed from.
+	 *
+	 * `owner` keeps the memory backing the source alive (ex. a `MappedFile` or
+	 * a shared string). If no owner is given, the caller must keep the source
+	 * alive for as long as the tree is used.
+	 */
+	struct SourceTree : Tree {
+		std::string_view source_text;
+		std::shared_ptr<const void> owner;
+
+		SourceTree() = default;
+		SourceTree(Tree&& tree, const std::string_view source, std::shared_ptr<const void> owner = {}) : Tree(std::move(tree)), source_text(source), owner(std::move(owner)) { }
+
+		/**
+		 * Get the source code the tree was parsed from.
+		 */
+		inline std::string_view source() const { return source_text; }
+		inline std::string_view get_source() const { return source(); }
+
+		/**
+		 * Get the source code covered by the given node, without copying.
+		 */
+		inline std::string_view text(const Node& node) const { return node.text(source_text); }
+		inline std::string_view get_text(const Node& node) const { return text(node); }
+
+		/**
+		 * Edit the syntax tree and switch it over to the edited source.
+		 *
+		 * The tree's byte offsets and its source always have to describe the same
+		 * text, so unlike `Tree::edit` the new source has to be provided alongside
+		 * the edit.
+		 */
+		void edit(const TSInputEdit& edit, const std::string_view new_source, std::shared_ptr<const void> new_owner = {}) {
+			Tree::edit(edit);
+			source_text = new_source;
+			owner = std::move(new_owner);
+		}
+	};
+
 	void ts_tree_delete(Tree p) = delete;
 }
 
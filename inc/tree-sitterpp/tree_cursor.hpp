@@ -3,17 +3,26 @@
 
 #include "helpers.hpp"
 #include "node.hpp"
+#include <vector>
 
 namespace TreeSitter {
 
 	struct TreeCursor : TSTreeCursor {
+		// Index of each node below the cursor's root within its parent, the back is the current node
+		std::vector<uint32_t> child_indices;
+
 		TreeCursor(Node n) : TSTreeCursor(ts_tree_cursor_new(n)) { }
 		TreeCursor(TSTreeCursor* move) : TSTreeCursor(*move) { }
-		TreeCursor(const TreeCursor& copy) : TSTreeCursor(ts_tree_cursor_copy(copy)) { }
-		TreeCursor(TreeCursor&&) = default;
+		TreeCursor(const TreeCursor& copy) : TSTreeCursor(ts_tree_cursor_copy(copy)), child_indices(copy.child_indices) { }
+		// The moved from cursor is left without a stack so its destructor doesn't free ours
+		TreeCursor(TreeCursor&& move) : TSTreeCursor(move), child_indices(std::move(move.child_indices)) { move.id = nullptr; move.context[0] = move.context[1] = 0; }
 		~TreeCursor() { ts_tree_cursor_delete(*this); }
-		inline TreeCursor& operator=(const TreeCursor& copy) { return *this = TreeCursor(copy); } // TODO: Works?
-		TreeCursor& operator=(TreeCursor&&) = default;
+		inline TreeCursor& operator=(const TreeCursor& copy) { return *this = TreeCursor(copy); }
+		TreeCursor& operator=(TreeCursor&& move) {
+			std::swap(static_cast<TSTreeCursor&>(*this), static_cast<TSTreeCursor&>(move));
+			std::swap(child_indices, move.child_indices);
+			return *this;
+		}
 
 		inline operator TSTreeCursor*() { return this; }
 		inline operator const TSTreeCursor*() const { return this; }
@@ -22,20 +31,24 @@ namespace TreeSitter {
 		/**
 		 * Re-initialize a tree cursor to start at a different node.
 		 */
-		void reset(const Node& node) { ts_tree_cursor_reset(*this, node); }
+		void reset(const Node& node) { ts_tree_cursor_reset(*this, node); child_indices.clear(); }
 
 		/**
 		 * Get the tree cursor's current node.
 		 */
-		Node current_node() { return ts_tree_cursor_current_node(*this); }
+		Node current_node() const { return ts_tree_cursor_current_node(*this); }
 
 		/**
 		 * Get the field name of the tree cursor's current node.
 		 *
-		 * This returns `NULL` if the current node doesn't have a field.
+		 * This returns nothing if the current node doesn't have a field.
 		 * See also `ts_node_child_by_field_name`.
 		 */
-		const std::string_view current_field_name() { return ts_tree_cursor_current_field_name(*this); }
+		std::optional<std::string_view> current_field_name() {
+			auto name = ts_tree_cursor_current_field_name(*this);
+			if(name == nullptr) return {};
+			return name;
+		}
 
 		/**
 		 * Get the field id of the tree cursor's current node.
@@ -45,13 +58,31 @@ namespace TreeSitter {
 		 */
 		TSFieldId current_field_id() { return ts_tree_cursor_current_field_id(*this); }
 
+		/**
+		 * Get the index of the tree cursor's current node within its parent.
+		 *
+		 * This is tracked as the cursor moves so it is constant time, except on the
+		 * node the cursor was started at which falls back to `Node::child_index`.
+		 */
+		uint32_t current_child_index() { return child_indices.empty() ? current_node().child_index() : child_indices.back(); }
+
+		/**
+		 * Get how many levels below the node the cursor was started at the cursor's
+		 * current node is.
+		 */
+		inline uint32_t current_depth() const { return child_indices.size(); }
+
 		/**
 		 * Move the cursor to the parent of its current node.
 		 *
 		 * This returns `true` if the cursor successfully moved, and returns `false`
 		 * if there was no parent node (the cursor was already on the root node).
 		 */
-		bool goto_parent() { return ts_tree_cursor_goto_parent(*this); }
+		bool goto_parent() {
+			if(!ts_tree_cursor_goto_parent(*this)) return false;
+			if(!child_indices.empty()) child_indices.pop_back();
+			return true;
+		}
 
 		/**
 		 * Move the cursor to the next sibling of its current node.
@@ -59,7 +90,11 @@ namespace TreeSitter {
 		 * This returns `true` if the cursor successfully moved, and returns `false`
 		 * if there was no next sibling node.
 		 */
-		bool goto_next_sibling() { return ts_tree_cursor_goto_next_sibling(*this); }
+		bool goto_next_sibling() {
+			if(!ts_tree_cursor_goto_next_sibling(*this)) return false;
+			if(!child_indices.empty()) child_indices.back()++;
+			return true;
+		}
 
 		/**
 		 * Move the cursor to the first child of its current node.
@@ -67,7 +102,11 @@ namespace TreeSitter {
 		 * This returns `true` if the cursor successfully moved, and returns `false`
 		 * if there were no children.
 		 */
-		bool goto_first_child() { return ts_tree_cursor_goto_first_child(*this); }
+		bool goto_first_child() {
+			if(!ts_tree_cursor_goto_first_child(*this)) return false;
+			child_indices.push_back(0);
+			return true;
+		}
 
 		/**
 		 * Move the cursor to the first child of its current node that extends beyond
@@ -76,8 +115,13 @@ namespace TreeSitter {
 		 * This returns the index of the child node if one was found, and returns -1
 		 * if no such child was found.
 		 */
-		int64_t goto_first_child_for_byte(uint32_t byte) { return ts_tree_cursor_goto_first_child_for_byte(*this, byte); }
-		int64_t goto_first_child_for_point(TSPoint point) { return ts_tree_cursor_goto_first_child_for_point(*this, point); }
+		int64_t goto_first_child_for_byte(uint32_t byte) { return track_child(ts_tree_cursor_goto_first_child_for_byte(*this, byte)); }
+		int64_t goto_first_child_for_point(TSPoint point) { return track_child(ts_tree_cursor_goto_first_child_for_point(*this, point)); }
+
+		inline int64_t track_child(int64_t index) {
+			if(index >= 0) child_indices.push_back(index);
+			return index;
+		}
 
 	};
 
@@ -0,0 +1,171 @@
+#ifndef __TREE_SITTERPP_VISITOR_HPP__
+#define __TREE_SITTERPP_VISITOR_HPP__
+
+#include "node.hpp"
+#include "tree_cursor.hpp"
+#include <algorithm>
+#include <array>
+#include <tuple>
+#include <utility>
+
+namespace TreeSitter {
+
+	// What a visitor's walk should do after a handler returns
+	enum class VisitResult : uint8_t {
+		Continue,     // Carry on into the node's children
+		SkipChildren, // Carry on with the node's next sibling
+		Stop,         // End the walk
+	};
+
+	/**
+	 * A handler registered for one or more symbols, see `on`.
+	 */
+	template<typename F, TSSymbol... Symbols>
+	struct SymbolHandler {
+		F handler;
+	};
+
+	/**
+	 * Register a handler for the given symbols, ex:
+	 *
+	 *   ts::on<ts::cpp::call_expression>([&](ts::Node call) { ... })
+	 *   ts::on<ts::cpp::class_specifier, ts::cpp::struct_specifier>([&](ts::Node type, ts::TreeCursor& cursor) { ... })
+	 *
+	 * Handlers take the node (and optionally the walk's cursor, ex. to check
+	 * `current_field_id`) and return a `VisitResult` or nothing (`Continue`).
+	 */
+	template<auto... Symbols, typename F>
+	inline SymbolHandler<F, (TSSymbol)Symbols...> on(F handler) {
+		static_assert(sizeof...(Symbols) > 0, "A handler needs at least one symbol");
+		return {std::move(handler)};
+	}
+
+	namespace detail {
+		template<typename H> struct HandlerSymbols;
+		template<typename F, TSSymbol... Symbols>
+		struct HandlerSymbols<SymbolHandler<F, Symbols...>> { static constexpr std::array<TSSymbol, sizeof...(Symbols)> symbols = {Symbols...}; };
+
+		// Deliberately not constexpr, reaching it while building a jump table makes registering a symbol twice fail to compile
+		inline void duplicate_visitor_symbol() {}
+
+		template<typename F>
+		inline VisitResult invoke_visit_handler(F& handler, const Node& node, TreeCursor& cursor) {
+			if constexpr(std::is_invocable_v<F&, const Node&, TreeCursor&>) {
+				if constexpr(std::is_void_v<std::invoke_result_t<F&, const Node&, TreeCursor&>>) {
+					handler(node, cursor);
+					return VisitResult::Continue;
+				} else return handler(node, cursor);
+			} else {
+				if constexpr(std::is_void_v<std::invoke_result_t<F&, const Node&>>) {
+					handler(node);
+					return VisitResult::Continue;
+				} else return handler(node);
+			}
+		}
+	}
+
+	/**
+	 * Walks a tree in preorder with a single cursor, calling the handler
+	 * registered for each node's symbol, ex:
+	 *
+	 *   ts::Visitor visitor{
+	 *     ts::on<ts::cpp::function_definition>([&](ts::Node function) { functions++; }),
+	 *     ts::on<ts::cpp::string_literal>([&](ts::Node) { return ts::VisitResult::SkipChildren; }),
+	 *   };
+	 *   visitor.walk(tree.root_node());
+	 *
+	 * Dispatch is a dense jump table indexed by `TSSymbol` built at compile time,
+	 * so each node costs one bounds check and (if a handler is registered) one
+	 * indirect call, instead of a chain of symbol or type string comparisons.
+	 * Nodes without a handler are walked into.
+	 */
+	template<typename... Handlers>
+	struct Visitor {
+		using Dispatch = VisitResult (*)(Visitor&, const Node&, TreeCursor&);
+
+		std::tuple<Handlers...> handlers;
+
+		Visitor(Handlers... handlers) : handlers(std::move(handlers)...) { }
+
+		// One past the largest registered symbol
+		static constexpr size_t table_size = [] {
+			size_t size = 0;
+			((size = std::max<size_t>(size, *std::max_element(detail::HandlerSymbols<Handlers>::symbols.begin(), detail::HandlerSymbols<Handlers>::symbols.end()) + 1)), ...);
+			return size;
+		}();
+
+		/**
+		 * Get the handler index registered for each symbol, or -1 if none is.
+		 */
+		static constexpr std::array<int16_t, table_size> handler_indices = [] {
+			std::array<int16_t, table_size> indices;
+			indices.fill(-1);
+			[[maybe_unused]] int16_t index = 0;
+			([&] {
+				for(TSSymbol symbol: detail::HandlerSymbols<Handlers>::symbols) {
+					if(indices[symbol] != -1) detail::duplicate_visitor_symbol();
+					indices[symbol] = index;
+				}
+				index++;
+			}(), ...);
+			return indices;
+		}();
+
+		/**
+		 * Check if a handler is registered for the given symbol.
+		 */
+		static constexpr bool handles(TSSymbol symbol) { return symbol < table_size && handler_indices[symbol] != -1; }
+
+		/**
+		 * Walk the subtree rooted at the given node (including the node itself).
+		 * Returns false if a handler stopped the walk.
+		 */
+		bool walk(const Node& root) {
+			if(root.is_null()) return true;
+			TreeCursor cursor(root);
+			return walk(cursor);
+		}
+
+		/**
+		 * Walk the subtree rooted at the cursor's current node, the cursor is left
+		 * where the walk stopped (back on its starting node if it wasn't stopped).
+		 */
+		bool walk(TreeCursor& cursor) {
+			const uint32_t root_depth = cursor.current_depth();
+			while(true) {
+				VisitResult result = visit(cursor.current_node(), cursor);
+				if(result == VisitResult::Stop) return false;
+				if(result == VisitResult::Continue && cursor.goto_first_child()) continue;
+				while(cursor.current_depth() > root_depth && !cursor.goto_next_sibling())
+					cursor.goto_parent();
+				if(cursor.current_depth() == root_depth) return true;
+			}
+		}
+
+		/**
+		 * Call the handler registered for the node's symbol without walking,
+		 * returning `Continue` if there is none.
+		 */
+		inline VisitResult visit(const Node& node, TreeCursor& cursor) {
+			TSSymbol symbol = node.symbol();
+			return symbol < table_size && jump_table[symbol] ? jump_table[symbol](*this, node, cursor) : VisitResult::Continue;
+		}
+
+		// Calls the I-th handler, the jump table's entries
+		template<size_t I>
+		static VisitResult call(Visitor& self, const Node& node, TreeCursor& cursor) {
+			return detail::invoke_visit_handler(std::get<I>(self.handlers).handler, node, cursor);
+		}
+
+		// The dispatch function for each symbol, null if no handler is registered
+		static constexpr std::array<Dispatch, table_size> jump_table = []<size_t... I>(std::index_sequence<I...>) {
+			constexpr std::array<Dispatch, sizeof...(I)> handlers = {&call<I>...};
+			std::array<Dispatch, table_size> table{};
+			for(size_t symbol = 0; symbol < table_size; symbol++)
+				if(handler_indices[symbol] != -1) table[symbol] = handlers[handler_indices[symbol]];
+			return table;
+		}(std::index_sequence_for<Handlers...>{});
+	};
+}
+
+#endif // __TREE_SITTERPP_VISITOR_HPP__
\ No newline at end of file
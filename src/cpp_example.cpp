@@ -3,6 +3,7 @@
 #include <cassert>
 #include "tspp/parser.hpp"
 #include "tspp/languages/cpp.hpp"
+#include "tspp/visitor.hpp"
 
 using namespace std::literals;
 
@@ -17,7 +18,7 @@ int main() {
 
 	// Build a syntax tree based on source code stored in a string.
 	std::string source_code = "#include <iostream>\n[[depreciated]] int main() { auto print = []{std::cout << \"Hello World\" << std::endl;}; print(); }";
-	auto tree = parser.parse_string(source_code);
+	auto tree = parser.parse_source(source_code);
 
 	// Get the root node of the syntax tree.
 	auto root_node = tree.root_node();
@@ -42,10 +43,17 @@ int main() {
 
 	assert(*stringNode.field_name() == "path"sv);
 
-	auto [start, end] = stringNode.byte_range();
-	for(size_t i = start; i < end; i++)
-		std::cout << source_code[i];
-	std::cout << " - " << stringNode.symbol() << std::endl;
+	std::cout << tree.text(stringNode) << " - " << stringNode.symbol() << std::endl;
+
+	// Walk the tree dispatching on each node's symbol, without comparing type strings.
+	size_t calls = 0, lambdas = 0;
+	ts::Visitor visitor{
+		ts::on<ts::cpp::Symbols::call_expression>([&](ts::Node) { calls++; }),
+		ts::on<ts::cpp::Symbols::lambda_expression>([&](ts::Node) { lambdas++; }),
+		ts::on<ts::cpp::Symbols::preproc_include>([&](ts::Node) { return ts::VisitResult::SkipChildren; }),
+	};
+	visitor.walk(root_node);
+	assert(calls == 1 && lambdas == 1);
 
 	// Print the syntax tree as an S-expression.
 	std::cout << root_node.string() << std::endl;
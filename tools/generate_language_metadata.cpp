@@ -0,0 +1,381 @@
+// Generates a header of constexpr symbol and field metadata for a tree-sitter language.
+//
+// Usage: generate_language_metadata --language <name> --parser <parser.c> [--node-types <node-types.json>] --output <header>
+//
+// The symbol and field enums, names, and visible/named/supertype flags are read from the
+// tables in the grammar's generated parser.c. Supertype membership is read from
+// node-types.json when it is given.
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <optional>
+#include <regex>
+#include <set>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+	struct Symbol {
+		std::string enumerator; // As named in parser.c, ex. anon_sym_LPAREN
+		std::string name;       // Escaped C string contents, ex. (
+		bool visible = false, named = false, supertype = false;
+	};
+
+	struct Supertype {
+		uint32_t symbol;
+		std::vector<uint32_t> subtypes;
+	};
+
+	[[noreturn]] void fail(const std::string& message) {
+		fprintf(stderr, "generate_language_metadata: %s\n", message.c_str());
+		exit(1);
+	}
+
+	std::string read_file(const std::string& path) {
+		std::ifstream file(path, std::ios::binary);
+		if(!file) fail("couldn't read " + path);
+		std::stringstream out;
+		out << file.rdbuf();
+		return out.str();
+	}
+
+	// Finds the `{ ... };` initializer following `header`, or nothing if the header isn't present
+	std::optional<std::string_view> find_block(std::string_view source, std::string_view header, size_t from = 0) {
+		size_t start = source.find(header, from);
+		if(start == std::string_view::npos) return {};
+		start = source.find('{', start);
+		size_t end = source.find("\n};", start);
+		if(start == std::string_view::npos || end == std::string_view::npos) return {};
+		return source.substr(start + 1, end - start);
+	}
+
+	// Calls `f(match)` for every match of the pattern in the text
+	template<typename F>
+	void for_each_match(std::string_view text, const std::regex& pattern, F&& f) {
+		for(std::cregex_iterator it(text.data(), text.data() + text.size(), pattern), end; it != end; ++it)
+			f(*it);
+	}
+
+	// Words which can't be used as enumerators (keywords and alternative operator tokens)
+	bool is_cpp_keyword(std::string_view name) {
+		static const std::string_view keywords[] = {
+			"alignas", "alignof", "and", "and_eq", "asm", "auto", "bitand", "bitor", "bool", "break", "case", "catch",
+			"char", "char8_t", "char16_t", "char32_t", "class", "compl", "concept", "const", "consteval", "constexpr",
+			"constinit", "const_cast", "continue", "co_await", "co_return", "co_yield", "decltype", "default", "delete",
+			"do", "double", "dynamic_cast", "else", "enum", "explicit", "export", "extern", "false", "float", "for",
+			"friend", "goto", "if", "inline", "int", "long", "mutable", "namespace", "new", "noexcept", "not", "not_eq",
+			"nullptr", "operator", "or", "or_eq", "private", "protected", "public", "register", "reinterpret_cast",
+			"requires", "return", "short", "signed", "sizeof", "static", "static_assert", "static_cast", "struct",
+			"switch", "template", "this", "thread_local", "throw", "true", "try", "typedef", "typeid", "typename",
+			"union", "unsigned", "using", "virtual", "void", "volatile", "wchar_t", "while", "xor", "xor_eq",
+		};
+		return std::find(std::begin(keywords), std::end(keywords), name) != std::end(keywords);
+	}
+
+	// Converts a parser.c enumerator to the name used in the generated enums, keywords get a
+	// trailing underscore (ex. `sym_true` -> `true_`) matching the hand written fallback enum.
+	// Fields lose their prefix too (`field_declarator` -> `fields::declarator`)
+	std::string enum_name(const std::string& enumerator) {
+		static const std::pair<std::string_view, std::string_view> prefixes[] = {
+			{"anon_sym_", "anon_"}, {"aux_sym_", "aux_"}, {"alias_sym_", "alias_"}, {"sym_", ""}, {"field_", ""},
+		};
+		std::string name = enumerator;
+		for(auto [prefix, replacement]: prefixes)
+			if(enumerator.starts_with(prefix)) {
+				name = std::string(replacement) + enumerator.substr(prefix.size());
+				break;
+			}
+		return is_cpp_keyword(name) ? name + "_" : name;
+	}
+
+	// Just enough of JSON to read node-types.json
+	struct Json {
+		enum Kind { Null, Bool, Number, String, Array, Object } kind = Null;
+		bool boolean = false;
+		std::string string;
+		std::vector<Json> array;
+		std::vector<std::pair<std::string, Json>> object;
+
+		const Json* get(std::string_view key) const {
+			for(auto& [name, value]: object)
+				if(name == key) return &value;
+			return nullptr;
+		}
+	};
+
+	struct JsonParser {
+		std::string_view text;
+		size_t at = 0;
+
+		void skip_space() { while(at < text.size() && isspace((unsigned char)text[at])) at++; }
+		bool consume(char c) {
+			skip_space();
+			if(at < text.size() && text[at] == c) { at++; return true; }
+			return false;
+		}
+		void expect(char c) { if(!consume(c)) fail(std::string("malformed node-types.json, expected '") + c + "'"); }
+
+		std::string parse_string() {
+			expect('"');
+			std::string out;
+			while(at < text.size() && text[at] != '"') {
+				if(text[at] == '\\' && at + 1 < text.size()) {
+					char escaped = text[++at];
+					switch(escaped) {
+					case 'n': out += '\n'; break;
+					case 't': out += '\t'; break;
+					case 'r': out += '\r'; break;
+					case 'u': {
+						unsigned code = std::stoul(std::string(text.substr(at + 1, 4)), nullptr, 16);
+						at += 4;
+						if(code < 0x80) out += (char)code;
+						else if(code < 0x800) { out += (char)(0xC0 | (code >> 6)); out += (char)(0x80 | (code & 0x3F)); }
+						else { out += (char)(0xE0 | (code >> 12)); out += (char)(0x80 | ((code >> 6) & 0x3F)); out += (char)(0x80 | (code & 0x3F)); }
+						break;
+					}
+					default: out += escaped; break;
+					}
+				} else out += text[at];
+				at++;
+			}
+			expect('"');
+			return out;
+		}
+
+		Json parse() {
+			skip_space();
+			Json out;
+			if(at >= text.size()) fail("malformed node-types.json, unexpected end");
+			char c = text[at];
+			if(c == '{') {
+				out.kind = Json::Object;
+				at++;
+				if(consume('}')) return out;
+				do {
+					std::string key = parse_string();
+					expect(':');
+					out.object.emplace_back(std::move(key), parse());
+				} while(consume(','));
+				expect('}');
+			} else if(c == '[') {
+				out.kind = Json::Array;
+				at++;
+				if(consume(']')) return out;
+				do out.array.push_back(parse()); while(consume(','));
+				expect(']');
+			} else if(c == '"') {
+				out.kind = Json::String;
+				out.string = parse_string();
+			} else if(text.substr(at, 4) == "true" || text.substr(at, 5) == "false") {
+				out.kind = Json::Bool;
+				out.boolean = text[at] == 't';
+				at += out.boolean ? 4 : 5;
+			} else if(text.substr(at, 4) == "null") at += 4;
+			else {
+				out.kind = Json::Number;
+				while(at < text.size() && (isdigit((unsigned char)text[at]) || strchr("+-.eE", text[at]))) at++;
+			}
+			return out;
+		}
+	};
+
+	// Escapes raw text (from node-types.json) for a C string literal, matching parser.c's escaping
+	std::string escape(std::string_view raw) {
+		std::string out;
+		for(char c: raw) {
+			switch(c) {
+			case '\\': out += "\\\\"; break;
+			case '"': out += "\\\""; break;
+			case '\n': out += "\\n"; break;
+			case '\t': out += "\\t"; break;
+			case '\r': out += "\\r"; break;
+			default: out += c; break;
+			}
+		}
+		return out;
+	}
+}
+
+int main(int argc, char** argv) {
+	std::string language, parser_path, node_types_path, output_path;
+	for(int i = 1; i + 1 < argc; i += 2) {
+		std::string_view flag = argv[i];
+		if(flag == "--language") language = argv[i + 1];
+		else if(flag == "--parser") parser_path = argv[i + 1];
+		else if(flag == "--node-types") node_types_path = argv[i + 1];
+		else if(flag == "--output") output_path = argv[i + 1];
+		else fail("unknown option " + std::string(flag));
+	}
+	if(language.empty() || parser_path.empty() || output_path.empty())
+		fail("usage: generate_language_metadata --language <name> --parser <parser.c> [--node-types <node-types.json>] --output <header>");
+
+	std::string parser = read_file(parser_path);
+
+	// Symbols and fields are enumerated in parser.c's enums (anonymous in older versions of
+	// tree-sitter, ts_symbol_identifiers and ts_field_identifiers in newer ones)
+	const std::regex enumerator(R"((\w+) = (\d+),)");
+	std::vector<Symbol> symbols(1);
+	symbols[0].enumerator = "ts_builtin_sym_end";
+	std::vector<std::string> field_enumerators(1);
+	for(size_t from = 0; auto block = find_block(parser, "\nenum ", from);) {
+		from = block->data() + block->size() - parser.data();
+		for_each_match(*block, enumerator, [&](const std::cmatch& match) {
+			std::string name = match[1];
+			size_t value = std::stoul(match[2]);
+			if(name.starts_with("field_")) {
+				if(field_enumerators.size() <= value) field_enumerators.resize(value + 1);
+				field_enumerators[value] = name;
+			} else if(name.starts_with("sym_") || name.starts_with("anon_sym_") || name.starts_with("aux_sym_") || name.starts_with("alias_sym_")) {
+				if(symbols.size() <= value) symbols.resize(value + 1);
+				symbols[value].enumerator = name;
+			}
+		});
+	}
+	if(symbols.size() <= 1) fail("no symbol enum found in " + parser_path);
+
+	std::map<std::string, size_t> symbol_ids;
+	for(size_t i = 0; i < symbols.size(); i++)
+		symbol_ids[symbols[i].enumerator] = i;
+	auto symbol_id = [&](const std::string& enumerator) {
+		auto found = symbol_ids.find(enumerator);
+		if(found == symbol_ids.end()) fail("unknown symbol " + enumerator);
+		return found->second;
+	};
+
+	auto names = find_block(parser, "ts_symbol_names[] =");
+	if(!names) fail("no ts_symbol_names table found in " + parser_path);
+	for_each_match(*names, std::regex(R"re(\[(\w+)\] = "((?:[^"\\]|\\.)*)",)re"), [&](const std::cmatch& match) {
+		symbols[symbol_id(match[1])].name = match[2];
+	});
+
+	auto flags = find_block(parser, "ts_symbol_metadata[] =");
+	if(!flags) fail("no ts_symbol_metadata table found in " + parser_path);
+	for_each_match(*flags, std::regex(R"(\[(\w+)\] = \{([^}]*)\})"), [&](const std::cmatch& match) {
+		auto& symbol = symbols[symbol_id(match[1])];
+		std::string body = match[2];
+		symbol.visible = body.find(".visible = true") != std::string::npos;
+		symbol.named = body.find(".named = true") != std::string::npos;
+		symbol.supertype = body.find(".supertype = true") != std::string::npos;
+	});
+
+	std::vector<std::string> field_names(field_enumerators.size());
+	if(auto fields = find_block(parser, "ts_field_names[] ="))
+		for_each_match(*fields, std::regex(R"re(\[(\w+)\] = "((?:[^"\\]|\\.)*)",)re"), [&](const std::cmatch& match) {
+			for(size_t i = 1; i < field_enumerators.size(); i++)
+				if(field_enumerators[i] == match[1]) field_names[i] = match[2];
+		});
+
+	// Supertypes and their subtypes are referred to by (type, named) in node-types.json
+	std::vector<Supertype> supertypes;
+	if(!node_types_path.empty()) {
+		std::string text = read_file(node_types_path);
+		Json types = JsonParser{text}.parse();
+		auto lookup = [&](const Json& entry) -> std::optional<uint32_t> {
+			auto* type = entry.get("type");
+			auto* named = entry.get("named");
+			if(!type || !named) return {};
+			std::string name = escape(type->string);
+			for(uint32_t i = 0; i < symbols.size(); i++)
+				if(symbols[i].visible && symbols[i].named == named->boolean && symbols[i].name == name) return i;
+			// Supertypes are hidden rules, so they aren't visible
+			for(uint32_t i = 0; i < symbols.size(); i++)
+				if(symbols[i].supertype && symbols[i].name == name) return i;
+			return {};
+		};
+		for(auto& entry: types.array) {
+			auto* subtypes = entry.get("subtypes");
+			if(!subtypes) continue;
+			auto symbol = lookup(entry);
+			if(!symbol) {
+				fprintf(stderr, "generate_language_metadata: skipping unknown supertype %s\n", entry.get("type") ? entry.get("type")->string.c_str() : "?");
+				continue;
+			}
+			Supertype supertype{*symbol, {}};
+			for(auto& subtype: subtypes->array)
+				if(auto id = lookup(subtype)) supertype.subtypes.push_back(*id);
+			supertypes.push_back(std::move(supertype));
+		}
+	}
+
+	// Write the header
+	std::string guard = "__TREE_SITTERPP_LANGUAGES_";
+	for(char c: language) guard += toupper((unsigned char)c);
+	guard += "_METADATA_HPP__";
+
+	std::ostringstream out;
+	out << "// Generated by tools/generate_language_metadata.cpp from " << parser_path << ", do not edit\n"
+		<< "#ifndef " << guard << "\n#define " << guard << "\n\n"
+		<< "#include <tree-sitterpp/language_metadata.hpp>\n#include <array>\n\n"
+		<< "namespace TreeSitter::" << language << " {\n\n";
+
+	// Symbols share the language's namespace with the other generated names, fields get a namespace
+	// of their own since grammars reuse names between them (ex. tree-sitter-cpp's `field_initializer`
+	// symbol and `initializer` field). Reject anything which would still be declared twice
+	std::set<std::string> symbol_names = {"language", "detail", "metadata", "fields", "Symbols", "Fields"}, field_names_seen = {"Fields"};
+	for(size_t i = 1; i < symbols.size(); i++)
+		if(!symbols[i].enumerator.empty() && !symbol_names.insert(enum_name(symbols[i].enumerator)).second)
+			fail("symbol " + symbols[i].enumerator + " would be declared twice as " + enum_name(symbols[i].enumerator));
+	for(size_t i = 1; i < field_enumerators.size(); i++)
+		if(!field_enumerators[i].empty() && !field_names_seen.insert(enum_name(field_enumerators[i])).second)
+			fail("field " + field_enumerators[i] + " would be declared twice as " + enum_name(field_enumerators[i]));
+
+	out << "\t// Enum with all of the symbols in the language\n\tenum Symbols : TSSymbol {\n";
+	for(size_t i = 1; i < symbols.size(); i++)
+		if(!symbols[i].enumerator.empty())
+			out << "\t\t" << enum_name(symbols[i].enumerator) << " = " << i << ",\n";
+	out << "\t};\n\n";
+
+	out << "\t// Enum with all of the fields in the language, ex. `fields::declarator`\n\tnamespace fields {\n\t\tenum Fields : TSFieldId {\n";
+	for(size_t i = 1; i < field_enumerators.size(); i++)
+		if(!field_enumerators[i].empty())
+			out << "\t\t\t" << enum_name(field_enumerators[i]) << " = " << i << ",\n";
+	out << "\t\t};\n\t}\n\tusing fields::Fields;\n\n";
+
+	out << "\tnamespace detail {\n";
+	out << "\t\tinline constexpr std::array<SymbolMetadata, " << symbols.size() << "> symbol_table = {{\n";
+	for(auto& symbol: symbols)
+		out << "\t\t\t{\"" << symbol.name << "\", " << (symbol.visible ? "true" : "false") << ", " << (symbol.named ? "true" : "false")
+			<< ", " << (symbol.supertype ? "true" : "false") << "},\n";
+	out << "\t\t}};\n\n";
+
+	out << "\t\tinline constexpr std::array<std::string_view, " << field_names.size() << "> field_table = {{\n";
+	for(auto& name: field_names)
+		out << "\t\t\t\"" << name << "\",\n";
+	out << "\t\t}};\n\n";
+
+	for(auto& supertype: supertypes) {
+		out << "\t\tinline constexpr std::array<TSSymbol, " << supertype.subtypes.size() << "> subtypes_of_" << supertype.symbol << " = {";
+		for(size_t i = 0; i < supertype.subtypes.size(); i++)
+			out << (i ? ", " : "") << supertype.subtypes[i];
+		out << "};\n";
+	}
+	out << "\t\tinline constexpr std::array<SupertypeMetadata, " << supertypes.size() << "> supertype_table = {{\n";
+	for(auto& supertype: supertypes)
+		out << "\t\t\t{" << supertype.symbol << ", subtypes_of_" << supertype.symbol << "},\n";
+	out << "\t\t}};\n\t}\n\n";
+
+	out << "\t// Constant expression symbol and field metadata, see `LanguageMetadata`\n"
+		<< "\tusing metadata = LanguageMetadata<detail::symbol_table, detail::field_table, detail::supertype_table>;\n"
+		<< "}\n\n#endif // " << guard;
+
+	// Only touch the header if it changed, so dependents aren't rebuilt needlessly
+	std::string generated = out.str();
+	{
+		std::ifstream existing(output_path, std::ios::binary);
+		std::stringstream current;
+		if(existing) current << existing.rdbuf();
+		if(existing && current.str() == generated) return 0;
+	}
+	std::ofstream file(output_path, std::ios::binary | std::ios::trunc);
+	if(!(file << generated)) fail("couldn't write " + output_path);
+	return 0;
+}
\ No newline at end of file